@@ -0,0 +1,272 @@
+/* NashEqCalcBench - timings of the solver hot paths and, with --solves, of whole solves of the position presets, to
+ * compare builds against each other. It runs on the data files NashEqCalc uses (same --equity-file / --frequency-file options and
+ * environment variables) or, with --synthetic, on tables generated in memory so it needs no data at all.
+ *
+ *      usage: NashEqCalcBench [--synthetic] [--solves] [--threads N] [--equity-file <path>] [--frequency-file <path>] [filter]
+ *             only the benchmarks whose name contains filter run, the solve/ ones only with --solves
+ *
+ * Every benchmark prints ns/op, evaluations/sec (calc_iteration_value profiles, or lookups for the lookup ones) and
+ * allocations/op, counted by the global operator new below.
+ */
+
+#include "nash_eq_calc.h"
+
+#include <chrono>
+#include <iomanip>
+#include <new>
+#include <random>
+
+/* Functions - done:
+ *      1. operator new / delete - count every heap allocation of the process
+ *      2. run_benchmark - time one benchmark and print its line
+ *      3. random_profile - a strategy_profile drawn from a strategy_space
+ *
+ */
+
+static atomic<uint64_t> allocations(0);
+
+void * operator new(size_t size){
+    allocations.fetch_add(1, memory_order_relaxed);
+    if(void * ptr = malloc(size ? size : 1)){
+        return ptr;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void * ptr) noexcept{
+    free(ptr);
+}
+
+void operator delete(void * ptr, size_t) noexcept{
+    free(ptr);
+}
+
+template <typename Run>
+void run_benchmark(ostream & report, const string & name, const string & filter, uint64_t ops, uint64_t evaluations, Run run);
+strategy_profile random_profile(const strategy_space & space, mt19937_64 & random);
+
+int main(int argc, char *argv[]){
+    bool synthetic = false, solves = false;
+    int kept = 1;
+    for(int i = 1; i < argc; i++){
+        if(string(argv[i]) == "--synthetic"){
+            synthetic = true;
+        } else if(string(argv[i]) == "--solves"){
+            solves = true;
+        } else{
+            argv[kept++] = argv[i];
+        }
+    }
+    run_options options;
+    argc = parse_options(kept, argv, options);
+    if(argc < 0 || argc > 2){
+        cout << "--Help: NashEqCalcBench [--synthetic] [--solves] [--threads N] [--equity-file <path>] [--frequency-file <path>] [filter]" << endl;
+        return 1;
+    }
+    const string filter = argc == 2 ? argv[1] : "";
+
+    // the solvers and loaders log to cout, only the benchmark lines are kept
+    ostream report(cout.rdbuf());
+    streambuf * const log = cout.rdbuf();
+    auto quiet = [&](bool on){
+        cout.rdbuf(on ? nullptr : log);
+        cout.clear();
+    };
+
+    const positions_ranges values{0, 5, 10, 15, 20, 25, 30, 35, 40, 45, 50, 60, 70};
+    map_ranges_equity equity_map;
+    map_scenario_probability probability_map;
+    if(synthetic){
+        equity_map = synthetic_ranges_equity(values);
+        probability_map = synthetic_scenario_probability(values);
+    }
+    report << "-I- NashEqCalcBench on " << (synthetic ? string("synthetic tables") : options.equity_file + ", " + options.frequency_file)
+           << ", threads: " << options.threads << endl;
+
+    ranges_equity_table ranges_equity;
+    scenario_probability_table scenario_probability;
+    quiet(true);
+    run_benchmark(report, "load/ranges_equity", filter, 1, 0, [&]{
+        ranges_equity = synthetic ? build_ranges_equity_table(equity_map) : load_ranges_equity_table(table_file_path(options.equity_file));
+    });
+    run_benchmark(report, "load/scenario_probability", filter, 1, 0, [&]{
+        scenario_probability = synthetic ? build_scenario_probability_table(probability_map) :
+                               load_scenario_probability_table(table_file_path(options.frequency_file));
+    });
+    quiet(false);
+    if(ranges_equity.storage == nullptr){
+        ranges_equity = synthetic ? build_ranges_equity_table(equity_map) : load_ranges_equity_table(table_file_path(options.equity_file));
+    }
+    if(scenario_probability.storage == nullptr){
+        scenario_probability = synthetic ? build_scenario_probability_table(probability_map) :
+                               load_scenario_probability_table(table_file_path(options.frequency_file));
+    }
+
+    // lookup keys are drawn up front from the entries the tables hold, so the timed loops only look up
+    mt19937_64 random(2021);
+    const size_t lookups = 1 << 22;
+    vector<array<int, POSITIONS_NUM + 1> > equity_keys, probability_keys;
+    auto random_key = [&](const range_buckets * buckets, int scenario){
+        array<int, POSITIONS_NUM + 1> key;
+        for(int position = 0; position < POSITIONS_NUM; position++){
+            key[position] = buckets[position].values[random() % buckets[position].values.size()];
+        }
+        key[POSITIONS_NUM] = scenario;
+        return key;
+    };
+    while(equity_keys.size() < lookups){
+        const array<int, POSITIONS_NUM + 1> key = random_key(ranges_equity.buckets, 0);
+        if(!std::isnan(ranges_equity.equities[table_entry(ranges_equity.buckets, key[0], key[1], key[2], key[3])][0])){
+            equity_keys.push_back(key);
+        }
+    }
+    while(probability_keys.size() < lookups){
+        const array<int, POSITIONS_NUM + 1> key = random_key(scenario_probability.buckets, random() % SCENARIOS_NUM);
+        if(!std::isnan(scenario_probability.probabilities[table_entry(scenario_probability.buckets, key[0], key[1], key[2], key[3]) *
+                                                          SCENARIOS_NUM + key[4]])){
+            probability_keys.push_back(key);
+        }
+    }
+
+    volatile double sink = 0;
+    run_benchmark(report, "lookup/get_ranges_equity", filter, lookups, lookups, [&]{
+        double sum = 0;
+        for(const auto & key : equity_keys){
+            sum += get_ranges_equity(ranges_equity, key[0], key[1], key[2], key[3])[0];
+        }
+        sink = sum;
+    });
+    run_benchmark(report, "lookup/get_scenario_probability", filter, lookups, lookups, [&]{
+        double sum = 0;
+        for(const auto & key : probability_keys){
+            sum += get_scenario_probability(scenario_probability, key[0], key[1], key[2], key[3], Scenario(key[4]));
+        }
+        sink = sum;
+    });
+
+    const double all_in = 1.0, small_blind = 0.05, big_blind = 0.1;
+    for(const string pos : {"co", "de", "sb"}){
+        strategy_space space;
+        init_ranges(pos, space.axes[0], space.axes[1], space.axes[2], space.axes[3], space.axes[4], space.axes[5], space.axes[6],
+                    space.axes[7], space.axes[8], space.axes[9], space.axes[10], space.axes[11], space.axes[12], space.axes[13]);
+        const uint64_t total_iter = strategy_space_size(space, 0, STRATEGY_AXES_NUM);
+
+        const size_t profiles_num = 1 << 16;
+        vector<strategy_profile> profiles;
+        for(size_t i = 0; i < profiles_num; i++){
+            profiles.push_back(random_profile(space, random));
+        }
+        run_benchmark(report, "eval/calc_iteration_value/" + pos, filter, profiles_num, profiles_num, [&]{
+            double sum = 0;
+            for(const strategy_profile & profile : profiles){
+                sum += calc_iteration_value(all_in, big_blind, small_blind, profile, ranges_equity, scenario_probability)[0];
+            }
+            sink = sum;
+        });
+
+        // the inner loop of the sweeps: neighbouring profiles only restage the scenarios of the axes that moved
+        run_benchmark(report, "eval/staged_sweep/" + pos, filter, total_iter, total_iter, [&]{
+            staged_evaluator evaluator = make_staged_evaluator(all_in, big_blind, small_blind, ranges_equity, scenario_probability);
+            strategy_cursor cursor;
+            cursor_seek(space, cursor, 0, 0, STRATEGY_AXES_NUM);
+            double sum = 0;
+            int changed = 0;
+            for(uint64_t i = 0; i < total_iter; i++, changed = cursor_next(space, cursor, 0, STRATEGY_AXES_NUM)){
+                stage_profile(evaluator, cursor.profile, changed, 0, POSITIONS_NUM);
+                sum += staged_value(evaluator)[0];
+            }
+            sink = sum;
+        });
+
+        // the sweeps since the batches: the values of a block of the innermost big blind axes are summed together
+        run_benchmark(report, "eval/batch_sweep/" + pos, filter, total_iter, total_iter, [&]{
+            staged_batch batch = make_staged_batch(make_staged_evaluator(all_in, big_blind, small_blind, ranges_equity, scenario_probability),
+                                                   space, batch_first_axis(space, seat_axes[3], STRATEGY_AXES_NUM, BATCH_MAX_PROFILES),
+                                                   STRATEGY_AXES_NUM, 0, POSITIONS_NUM);
+            strategy_cursor cursor;
+            cursor_seek(space, cursor, 0, 0, STRATEGY_AXES_NUM);
+            double sum = 0;
+            for(uint64_t i = 0; i < total_iter; i++, cursor_next(space, cursor, 0, STRATEGY_AXES_NUM)){
+                if(i % batch.size == 0){
+                    stage_batch(batch, cursor.profile);
+                }
+                sum += batch_value(batch, i % batch.size)[0];
+            }
+            sink = sum;
+        });
+
+        // the sweeps with --payoff-cache: one dot product per position instead of the staged lookups
+        payoff_table payoffs;
+        quiet(true);
+        run_benchmark(report, "build/payoff_table/" + pos, filter, 1, total_iter, [&]{
+            payoffs = build_payoff_table(ranges_equity, scenario_probability, space, options.threads);
+        });
+        if(payoffs.storage == nullptr && ("eval/payoff_sweep/" + pos).find(filter) != string::npos){
+            payoffs = build_payoff_table(ranges_equity, scenario_probability, space, options.threads);
+        }
+        quiet(false);
+        run_benchmark(report, "eval/payoff_sweep/" + pos, filter, total_iter, total_iter, [&]{
+            const blind_config blinds{all_in, small_blind, big_blind};
+            strategy_cursor cursor;
+            cursor_seek(space, cursor, 0, 0, STRATEGY_AXES_NUM);
+            double sum = 0;
+            for(uint64_t i = 0; i < total_iter; i++, cursor_next(space, cursor, 0, STRATEGY_AXES_NUM)){
+                sum += payoff_value(payoffs.coefficients[pack_profile(payoffs.packer, cursor.profile)], blinds)[0];
+            }
+            sink = sum;
+        });
+        payoffs = payoff_table();
+
+        // whole solves take minutes per preset on the data files, they only run when asked for
+        if(!solves){
+            continue;
+        }
+        quiet(true);
+        run_benchmark(report, "solve/minmax/" + pos, filter, 1, total_iter, [&]{
+            strategy_space axes = space;
+            calc_min_max(ranges_equity, scenario_probability, all_in, small_blind, big_blind, options.threads,
+                         axes.axes[0], axes.axes[1], axes.axes[2], axes.axes[3], axes.axes[4], axes.axes[5], axes.axes[6],
+                         axes.axes[7], axes.axes[8], axes.axes[9], axes.axes[10], axes.axes[11], axes.axes[12], axes.axes[13]);
+        });
+        run_benchmark(report, "solve/nash/" + pos, filter, 1, total_iter, [&]{
+            strategy_space axes = space;
+            calc_nash_definition(ranges_equity, scenario_probability, all_in, small_blind, big_blind, 0.02, options.threads,
+                                 axes.axes[0], axes.axes[1], axes.axes[2], axes.axes[3], axes.axes[4], axes.axes[5], axes.axes[6],
+                                 axes.axes[7], axes.axes[8], axes.axes[9], axes.axes[10], axes.axes[11], axes.axes[12], axes.axes[13]);
+        });
+        quiet(false);
+    }
+
+    return 0;
+}
+
+/* *****************************************************
+ * Implementations:
+ * *****************************************************
+ */
+
+template <typename Run>
+void run_benchmark(ostream & report, const string & name, const string & filter, uint64_t ops, uint64_t evaluations, Run run){
+    if(name.find(filter) == string::npos){
+        return;
+    }
+    const uint64_t first_allocations = allocations.load();
+    const auto start = chrono::steady_clock::now();
+    run();
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    const double allocations_per_op = double(allocations.load() - first_allocations) / ops;
+
+    report << "-I- " << left << setw(36) << name << right << fixed << setprecision(1) << setw(16) << 1e9 * seconds / ops << " ns/op";
+    if(evaluations){
+        report << setprecision(0) << setw(14) << evaluations / seconds << " evaluations/sec";
+    }
+    report << setprecision(2) << setw(12) << allocations_per_op << " allocations/op" << endl;
+}
+
+strategy_profile random_profile(const strategy_space & space, mt19937_64 & random){
+    strategy_profile profile;
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        profile.*strategy_axes[axis] = space.axes[axis][random() % space.axes[axis].size()];
+    }
+    return profile;
+}
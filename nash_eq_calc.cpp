@@ -0,0 +1,3463 @@
+#include "nash_eq_calc.h"
+
+run_stats stats;
+bool progress_output = false;
+uint64_t nash_candidates_max = NASH_CANDIDATES_MAX;
+
+
+/* *****************************************************
+ * *****************************************************
+ * Implementations:
+ * *****************************************************
+ * *****************************************************
+ */
+
+Scenario string_to_scenario(string & str){
+    Scenario scenario;
+    if(!find_scenario(str.data(), str.size(), scenario)){
+        cout << "-E- invalid scenario" << endl;
+        throw exception();
+    }
+    return scenario;
+}
+
+bool find_scenario(const char * name, size_t length, Scenario & scenario){
+    for(int i = 0; i < SCENARIOS_NUM; i++){
+        if(strlen(scenario_names[i]) == length && memcmp(scenario_names[i], name, length) == 0){
+            scenario = Scenario(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+range_buckets build_range_buckets(const vector<bool> & present){
+    range_buckets buckets;
+    for(int range = 0; range <= MAX_RANGE; range++){
+        buckets.index[range] = -1;
+        if(present[range]){
+            buckets.index[range] = buckets.values.size();
+            buckets.values.push_back(range);
+        }
+    }
+    return buckets;
+}
+
+double get_scenario_probability(const scenario_probability_table & table, int co_range, int de_range, int sb_range, int bb_range,
+        Scenario scenario){
+    const int64_t entry = table_entry(table.buckets, co_range, de_range, sb_range, bb_range);
+    const double probability = entry >= 0 ? table.probabilities[entry * SCENARIOS_NUM + scenario] : numeric_limits<double>::quiet_NaN();
+
+    if(std::isnan(probability)){
+        cout << "-E- missing scenario probability, ranges: " << co_range << ", " << de_range << ", " << sb_range << ", "
+             << bb_range << " scenario: " << scenario << endl;
+        throw exception();
+    }
+    return probability;
+}
+
+int64_t table_entry(const range_buckets * buckets, int co_range, int de_range, int sb_range, int bb_range){
+    if(co_range < 0 || co_range > MAX_RANGE || de_range < 0 || de_range > MAX_RANGE ||
+       sb_range < 0 || sb_range > MAX_RANGE || bb_range < 0 || bb_range > MAX_RANGE){
+        return -1;
+    }
+    const int64_t co = buckets[0].index[co_range], de = buckets[1].index[de_range],
+            sb = buckets[2].index[sb_range], bb = buckets[3].index[bb_range];
+    if(co < 0 || de < 0 || sb < 0 || bb < 0){
+        return -1;
+    }
+    return ((co * buckets[1].values.size() + de) * buckets[2].values.size() + sb) * buckets[3].values.size() + bb;
+}
+
+scenario_probability_table build_scenario_probability_table(const map_scenario_probability & map){
+    scenario_probability_table table;
+
+    vector<bool> present(MAX_RANGE + 1, false);
+    for(auto const & entry : map){
+        for(auto range : get<0>(entry.first)){
+            if(range < 0 || range > MAX_RANGE){
+                cout << "-E- frequency_dict_data range out of bounds: " << range << endl;
+                throw exception();
+            }
+            present[range] = true;
+        }
+    }
+    fill(table.buckets, table.buckets + POSITIONS_NUM, build_range_buckets(present));
+    const range_buckets & buckets = table.buckets[0];
+
+    const size_t n = buckets.values.size();
+    auto probabilities = make_shared<vector<double> >(n * n * n * n * SCENARIOS_NUM, numeric_limits<double>::quiet_NaN());
+    for(auto const & entry : map){
+        const positions_ranges & ranges = get<0>(entry.first);
+        const size_t co = buckets.index[ranges[0]], de = buckets.index[ranges[1]],
+                sb = buckets.index[ranges[2]], bb = buckets.index[ranges[3]];
+        (*probabilities)[(((co * n + de) * n + sb) * n + bb) * SCENARIOS_NUM + get<1>(entry.first)] = entry.second;
+    }
+    table.probabilities = probabilities->data();
+    table.storage = probabilities;
+
+    size_t missing = count_if(probabilities->begin(), probabilities->end(), [](double p){ return std::isnan(p); });
+    cout << "-I- scenario probability table built: " << n << " range buckets, " << map.size() << " entries, "
+         << missing << " missing" << endl;
+    return table;
+}
+
+shared_ptr<mapped_file> map_file(const string & path){
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat file_stat;
+    if(fd < 0 || fstat(fd, &file_stat) != 0){
+        if(fd >= 0) close(fd);
+        return nullptr;
+    }
+    auto file = make_shared<mapped_file>();
+    file->size = file_stat.st_size;
+    if(file->size > 0){
+        file->data = mmap(nullptr, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if(file->size > 0 && file->data == MAP_FAILED){
+        return nullptr;
+    }
+    return file;
+}
+
+void scan_spaces(text_scanner & scanner){
+    while(scanner.pos < scanner.end && (*scanner.pos == ' ' || *scanner.pos == '\t' || *scanner.pos == '\r')){
+        scanner.pos++;
+    }
+}
+
+bool scan_char(text_scanner & scanner, char expected){
+    scan_spaces(scanner);
+    if(scanner.pos < scanner.end && *scanner.pos == expected){
+        scanner.pos++;
+        return true;
+    }
+    return false;
+}
+
+bool scan_int(text_scanner & scanner, int & value){
+    scan_spaces(scanner);
+    const bool negative = scanner.pos < scanner.end && *scanner.pos == '-';
+    if(negative){
+        scanner.pos++;
+    }
+    const char * digits = scanner.pos;
+    long long number = 0;
+    while(scanner.pos < scanner.end && *scanner.pos >= '0' && *scanner.pos <= '9'){
+        number = number * 10 + (*scanner.pos++ - '0');
+        if(number > numeric_limits<int>::max()){
+            return false;
+        }
+    }
+    value = negative ? -number : number;
+    return scanner.pos != digits;
+}
+
+bool scan_double(text_scanner & scanner, double & value){
+    // the token is copied out because strtod needs a terminated string, it keeps the values identical to stod
+    scan_spaces(scanner);
+    char token[64];
+    size_t length = 0;
+    while(scanner.pos < scanner.end && length < sizeof(token) - 1 &&
+          ((*scanner.pos >= '0' && *scanner.pos <= '9') || *scanner.pos == '.' || *scanner.pos == '-' ||
+           *scanner.pos == '+' || *scanner.pos == 'e' || *scanner.pos == 'E')){
+        token[length++] = *scanner.pos++;
+    }
+    token[length] = '\0';
+    char * token_end;
+    value = strtod(token, &token_end);
+    return length > 0 && token_end == token + length;
+}
+
+bool scan_scenario(text_scanner & scanner, Scenario & scenario){
+    if(!scan_char(scanner, '\'')){
+        return false;
+    }
+    const char * quote = static_cast<const char *>(memchr(scanner.pos, '\'', scanner.end - scanner.pos));
+    if(quote == nullptr || !find_scenario(scanner.pos, quote - scanner.pos, scenario)){
+        return false;
+    }
+    scanner.pos = quote + 1;
+    return true;
+}
+
+bool scan_line_end(text_scanner & scanner){
+    scan_spaces(scanner);
+    return scanner.pos == scanner.end;
+}
+
+template <typename Parse>
+void parse_data_file(const string & path, const string & name, Parse parse_line){
+    shared_ptr<mapped_file> file = map_file(path);
+    if(file){
+        cout << "-I- " << name << " file opened" << endl;
+    } else{
+        cout << "-E- failed to open " << name << " file, Exiting..." << endl;
+        throw exception();
+    }
+
+    const char * begin = static_cast<const char *>(file->data), * end = begin + file->size, * pos = begin;
+    size_t line = 0, errors = 0;
+    progress_meter progress;
+    start_progress(progress, name, "bytes", file->size);
+    while(pos < end){
+        const char * line_end = static_cast<const char *>(memchr(pos, '\n', end - pos));
+        if(line_end == nullptr){
+            line_end = end;
+        }
+        line++;
+
+        text_scanner scanner{pos, line_end};
+        if(!scan_line_end(scanner)){
+            scanner.pos = pos;
+            if(!parse_line(scanner)){
+                cout << "-E- " << name << " malformed line skipped, line: " << line << endl;
+                errors++;
+            }
+        }
+
+        pos = line_end + 1;
+        progress.done.store(min(pos, end) - begin, memory_order_relaxed);
+    }
+    finish_progress(progress);
+    if(errors){
+        cout << "-E- " << name << ": " << errors << " malformed lines of " << line << " skipped" << endl;
+    }
+}
+
+map_scenario_probability read_scenario_probability_file(const string & path){
+    map_scenario_probability scenario_probability = map_scenario_probability();
+
+    // ((co, de, sb, bb), 'scenario'):probability
+    parse_data_file(path, "frequency_dict_data", [&](text_scanner & scanner){
+        int co_range, de_range, sb_range, bb_range;
+        Scenario scenario;
+        double probability;
+        if(!(scan_char(scanner, '(') && scan_char(scanner, '(') && scan_int(scanner, co_range) &&
+             scan_char(scanner, ',') && scan_int(scanner, de_range) && scan_char(scanner, ',') && scan_int(scanner, sb_range) &&
+             scan_char(scanner, ',') && scan_int(scanner, bb_range) && scan_char(scanner, ')') && scan_char(scanner, ',') &&
+             scan_scenario(scanner, scenario) && scan_char(scanner, ')') && scan_char(scanner, ':') &&
+             scan_double(scanner, probability) && scan_line_end(scanner))){
+            return false;
+        }
+
+        // the file is written in key order, so hinting at the end keeps the insert constant time
+        auto key = make_tuple(positions_ranges{co_range, de_range, sb_range, bb_range}, scenario);
+        auto hint = scenario_probability.empty() || scenario_probability.rbegin()->first < key ?
+                    scenario_probability.end() : scenario_probability.lower_bound(key);
+        if(hint != scenario_probability.end() && hint->first == key){
+            hint->second = probability;
+        } else{
+            scenario_probability.emplace_hint(hint, move(key), probability);
+        }
+        return true;
+    });
+
+    return scenario_probability;
+}
+
+map_ranges_equity read_ranges_equity_file(const string & path){
+    map_ranges_equity ranges_equity_map = map_ranges_equity();
+
+    // (co, de, sb, bb):(co_equity, de_equity, sb_equity, bb_equity)
+    parse_data_file(path, "equity_dict_data", [&](text_scanner & scanner){
+        int co_range, de_range, sb_range, bb_range;
+        double co_equity, de_equity, sb_equity, bb_equity;
+        if(!(scan_char(scanner, '(') && scan_int(scanner, co_range) && scan_char(scanner, ',') && scan_int(scanner, de_range) &&
+             scan_char(scanner, ',') && scan_int(scanner, sb_range) && scan_char(scanner, ',') && scan_int(scanner, bb_range) &&
+             scan_char(scanner, ')') && scan_char(scanner, ':') && scan_char(scanner, '(') &&
+             scan_double(scanner, co_equity) && scan_char(scanner, ',') && scan_double(scanner, de_equity) &&
+             scan_char(scanner, ',') && scan_double(scanner, sb_equity) && scan_char(scanner, ',') &&
+             scan_double(scanner, bb_equity) && scan_char(scanner, ')') && scan_line_end(scanner))){
+            return false;
+        }
+
+        ranges_equity_map[positions_ranges{co_range, de_range, sb_range, bb_range}] =
+                positions_expectancy{co_equity, de_equity, sb_equity, bb_equity};
+        return true;
+    });
+
+    return ranges_equity_map;
+}
+
+const positions_equity & get_ranges_equity(const ranges_equity_table & table, int co_range, int de_range, int sb_range, int bb_range){
+    const int64_t entry = table_entry(table.buckets, co_range, de_range, sb_range, bb_range);
+    if(entry >= 0 && !std::isnan(table.equities[entry][0])){
+        return table.equities[entry];
+    }
+
+    cout << "-E- missing ranges equity, ranges: " << co_range << ", " << de_range << ", " << sb_range << ", " << bb_range << endl;
+    throw exception();
+}
+
+ranges_equity_table build_ranges_equity_table(const map_ranges_equity & map){
+    ranges_equity_table table;
+
+    vector<bool> present(MAX_RANGE + 1, false);
+    present[0] = true;
+    for(auto const & entry : map){
+        for(auto range : entry.first){
+            if(range < 0 || range > MAX_RANGE){
+                cout << "-E- equity_dict_data range out of bounds: " << range << endl;
+                throw exception();
+            }
+            present[range] = true;
+        }
+    }
+    fill(table.buckets, table.buckets + POSITIONS_NUM, build_range_buckets(present));
+    const range_buckets & buckets = table.buckets[0];
+
+    const size_t n = buckets.values.size();
+    const double nan = numeric_limits<double>::quiet_NaN();
+    auto equities = make_shared<vector<positions_equity> >(n * n * n * n, positions_equity{nan, nan, nan, nan});
+    table.equities = equities->data();
+    table.storage = equities;
+
+    for(size_t co = 0; co < n; co++) {
+        for (size_t de = 0; de < n; de++) {
+            for (size_t sb = 0; sb < n; sb++) {
+                for (size_t bb = 0; bb < n; bb++) {
+                    const positions_ranges unsort{buckets.values[co], buckets.values[de], buckets.values[sb], buckets.values[bb]};
+                    positions_ranges ranges = unsort;
+                    sort(ranges.begin(), ranges.end());
+
+                    positions_equity & equity_res = (*equities)[((co * n + de) * n + sb) * n + bb];
+                    if(ranges[2] == 0){
+                        equity_res = positions_equity{0,0,0,0};
+                        continue;
+                    }
+
+                    auto itr = map.find(ranges);
+                    if(itr == map.end()){
+                        continue;
+                    }
+
+                    // seats holding the same range share the equity of its first occurrence in the sorted key
+                    const positions_expectancy & expectancy_unsort = itr->second;
+                    for(int i = 0; i < 4; i++){
+                        equity_res[i] = expectancy_unsort[distance(ranges.begin(), find(ranges.begin(), ranges.end(), unsort[i]))];
+                    }
+
+                    if(abs(equity_res[0] + equity_res[1] + equity_res[2] + equity_res[3] - 100) > EQUITY_ERROR){
+                        cout << "-E- equity too divergent, total value: " ;
+                        cout << equity_res[0] + equity_res[1] + equity_res[2] + equity_res[3] << endl;
+                        cout << "    specific values: " << equity_res[0] << ", " << equity_res[1] << ", " <<
+                             equity_res[2] << ", " << equity_res[3] << endl;
+                        throw exception();
+                    }
+                }
+            }
+        }
+    }
+
+    size_t missing = count_if(equities->begin(), equities->end(), [](const positions_equity & e){ return std::isnan(e[0]); });
+    cout << "-I- ranges equity table built: " << map.size() << " entries, " << missing << " seat orders missing" << endl;
+    return table;
+}
+
+map_ranges_equity synthetic_ranges_equity(const positions_ranges & values){
+    // keyed by sorted ranges like equity_dict_data, a tighter range takes a larger share of the pot
+    map_ranges_equity map;
+    const size_t n = values.size();
+    for(size_t a = 0; a < n; a++){
+        for(size_t b = a; b < n; b++){
+            for(size_t c = b; c < n; c++){
+                for(size_t d = c; d < n; d++){
+                    const positions_ranges ranges{values[a], values[b], values[c], values[d]};
+                    if(ranges[2] == 0){
+                        continue;
+                    }
+                    double weights[POSITIONS_NUM], total = 0;
+                    for(int i = 0; i < POSITIONS_NUM; i++){
+                        weights[i] = ranges[i] ? 1.0 / ranges[i] : 0;
+                        total += weights[i];
+                    }
+                    positions_expectancy & equity = map[ranges];
+                    for(int i = 0; i < POSITIONS_NUM; i++){
+                        equity.push_back(100 * weights[i] / total);
+                    }
+                }
+            }
+        }
+    }
+    return map;
+}
+
+map_scenario_probability synthetic_scenario_probability(const positions_ranges & values){
+    // every position pushes (or calls) with probability range / 100, a scenario names the positions that do
+    const char * const seat_names[POSITIONS_NUM] = {"cutoff", "dealer", "smallblind", "bigblind"};
+    map_scenario_probability map;
+    for(int co : values){
+        for(int de : values){
+            for(int sb : values){
+                for(int bb : values){
+                    const int ranges[POSITIONS_NUM] = {co, de, sb, bb};
+                    for(int scenario = 0; scenario < SCENARIOS_NUM; scenario++){
+                        double probability = 100;
+                        for(int seat = 0; seat < POSITIONS_NUM; seat++){
+                            const bool pushes = scenario != empty_bigblind && strstr(scenario_names[scenario], seat_names[seat]);
+                            probability *= pushes ? ranges[seat] / 100.0 : 1 - ranges[seat] / 100.0;
+                        }
+                        map[make_tuple(positions_ranges{co, de, sb, bb}, Scenario(scenario))] = probability;
+                    }
+                }
+            }
+        }
+    }
+    return map;
+}
+
+void refine_range_grid(ranges_equity_table & ranges_equity, scenario_probability_table & scenario_probability, const strategy_space & space){
+    // the space is looked up on a grid of its own, built once, so the solvers keep their plain table lookups
+    auto refine = [&](const range_buckets * buckets, bool equity, range_buckets * grid){
+        vector<bool> present[POSITIONS_NUM];
+        grid_ranges(space, equity, present);
+        bool between = false;
+        for(int key = 0; key < POSITIONS_NUM; key++){
+            grid[key] = build_range_buckets(present[key]);
+            for(auto range : grid[key].values){
+                between = between || buckets[key].index[range] < 0;
+            }
+        }
+        return between;
+    };
+
+    const auto start = chrono::steady_clock::now();
+    range_buckets equity_grid[POSITIONS_NUM], probability_grid[POSITIONS_NUM];
+    const bool refine_equity = refine(ranges_equity.buckets, true, equity_grid),
+            refine_probability = refine(scenario_probability.buckets, false, probability_grid);
+    if(!refine_equity && !refine_probability){
+        return;
+    }
+    cout << "-I- Interpolating the tables for the ranges between the data buckets..." << endl;
+
+    uint64_t equity_entries = 1, probability_entries = 1;
+    for(int key = 0; key < POSITIONS_NUM; key++){
+        equity_entries *= equity_grid[key].values.size();
+        probability_entries *= probability_grid[key].values.size();
+    }
+    if(refine_equity){
+        const double nan = numeric_limits<double>::quiet_NaN();
+        auto equities = make_shared<vector<positions_equity> >(equity_entries, positions_equity{nan, nan, nan, nan});
+        interpolate_table(ranges_equity.buckets, ranges_equity.equities[0].data(), equity_grid, (*equities)[0].data(), POSITIONS_NUM, false);
+        copy(equity_grid, equity_grid + POSITIONS_NUM, ranges_equity.buckets);
+        ranges_equity.equities = equities->data();
+        ranges_equity.storage = equities;
+        cout << "-I- ranges equity grid: " << equity_entries << " entries" << endl;
+    }
+    if(refine_probability){
+        auto probabilities = make_shared<vector<double> >(probability_entries * SCENARIOS_NUM);
+        interpolate_table(scenario_probability.buckets, scenario_probability.probabilities, probability_grid, probabilities->data(),
+                          SCENARIOS_NUM, true);
+        copy(probability_grid, probability_grid + POSITIONS_NUM, scenario_probability.buckets);
+        scenario_probability.probabilities = probabilities->data();
+        scenario_probability.storage = probabilities;
+        cout << "-I- scenario probability grid: " << probability_entries << " entries" << endl;
+    }
+    record_phase("index_build", start);
+}
+
+void grid_ranges(const strategy_space & space, bool equity, vector<bool> * present){
+    for(int key = 0; key < POSITIONS_NUM; key++){
+        present[key].assign(MAX_RANGE + 1, false);
+    }
+    for(int scenario = 0; scenario < SCENARIOS_NUM; scenario++){
+        if(equity && !scenario_all_in(scenario, 0, POSITIONS_NUM)){
+            continue;
+        }
+        const int * keys = equity ? scenario_payoffs[scenario].equity_axes : scenario_payoffs[scenario].probability_axes;
+        for(int key = 0; key < POSITIONS_NUM; key++){
+            if(keys[key] < 0){
+                present[key][0] = true;
+                continue;
+            }
+            for(auto range : space.axes[keys[key]]){
+                present[key][range] = true;
+            }
+        }
+    }
+}
+
+void interpolate_table(const range_buckets * source, const double * source_data, const range_buckets * target, double * target_data,
+        uint32_t values_num, bool zero_node){
+    // every target range of a key lies on a source bucket or between two, a 0 range (a position that folds) only lies
+    // between buckets of the probabilities
+    struct grid_nodes {
+        vector<int> buckets[2];
+        vector<double> weights[2];
+    } nodes[POSITIONS_NUM];
+    for(int key = 0; key < POSITIONS_NUM; key++){
+        const vector<int> & values = source[key].values;
+        for(auto range : target[key].values){
+            int below = source[key].index[range], above = below;
+            double above_weight = 0;
+            if(below < 0){
+                above = upper_bound(values.begin(), values.end(), range) - values.begin();
+                below = above - 1;
+                if(above == (int)values.size() || below < 0 || (values[below] == 0 && !zero_node)){
+                    const int lowest = zero_node || values.size() < 2 || values[0] != 0 ? values.front() : values[1];
+                    cout << "-E- range " << range << " is outside of the data buckets, from " << lowest << " to " << values.back() << endl;
+                    throw exception();
+                }
+                above_weight = double(range - values[below]) / (values[above] - values[below]);
+            }
+            nodes[key].buckets[0].push_back(below);
+            nodes[key].buckets[1].push_back(above);
+            nodes[key].weights[0].push_back(1 - above_weight);
+            nodes[key].weights[1].push_back(above_weight);
+        }
+    }
+
+    // a corner of weight 0 is skipped, so a range on a bucket copies the data exactly and a missing neighbour (NaN) only
+    // spreads to the entries that really depend on it
+    const size_t n[POSITIONS_NUM] = {target[0].values.size(), target[1].values.size(), target[2].values.size(), target[3].values.size()};
+    const size_t source_n[POSITIONS_NUM] = {source[0].values.size(), source[1].values.size(), source[2].values.size(), source[3].values.size()};
+    double * entry = target_data;
+    for(size_t co = 0; co < n[0]; co++){
+        for(size_t de = 0; de < n[1]; de++){
+            for(size_t sb = 0; sb < n[2]; sb++){
+                for(size_t bb = 0; bb < n[3]; bb++, entry += values_num){
+                    const size_t index[POSITIONS_NUM] = {co, de, sb, bb};
+                    fill(entry, entry + values_num, 0.0);
+                    for(int corner = 0; corner < 1 << POSITIONS_NUM; corner++){
+                        double weight = 1;
+                        size_t source_entry = 0;
+                        for(int key = 0; key < POSITIONS_NUM; key++){
+                            const int side = corner >> (POSITIONS_NUM - 1 - key) & 1;
+                            weight *= nodes[key].weights[side][index[key]];
+                            source_entry = source_entry * source_n[key] + nodes[key].buckets[side][index[key]];
+                        }
+                        if(weight == 0){
+                            continue;
+                        }
+                        const double * values = source_data + source_entry * values_num;
+                        for(uint32_t value = 0; value < values_num; value++){
+                            entry[value] += weight * values[value];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void step_ranges(positions_ranges & ranges, int step){
+    if(ranges.size() < 2){
+        return;
+    }
+    const int first = *min_element(ranges.begin(), ranges.end()), last = *max_element(ranges.begin(), ranges.end());
+    ranges.clear();
+    for(int range = first; range < last; range += step){
+        ranges.push_back(range);
+    }
+    ranges.push_back(last);
+}
+
+void init_ranges(const string & pos, positions_ranges & co_range, positions_ranges & de_range, positions_ranges & de_co_range,
+                 positions_ranges & sb_range, positions_ranges & sb_co_range, positions_ranges & sb_de_range, positions_ranges & sb_co_de_range,
+                 positions_ranges & bb_co_range, positions_ranges & bb_de_range, positions_ranges & bb_sb_range,
+                 positions_ranges & bb_co_de_range, positions_ranges & bb_co_sb_range, positions_ranges & bb_de_sb_range, positions_ranges & bb_co_de_sb_range){
+
+    if(pos == "de" || pos == "DE" || pos == "Dealer" || pos == "dealer"){
+        co_range = positions_ranges{0};
+
+        de_range = positions_ranges{5,10,15,20,25,30,35,40,45,50,60,70};
+        de_co_range = positions_ranges{0};
+
+        sb_range = positions_ranges{5,10,15,20,25,30,35,40,45,50,60,70};
+        sb_co_range = positions_ranges{0};
+        sb_de_range = positions_ranges{5,10,15,20,25,30,35,40,45,50,60,70};
+        sb_co_de_range = positions_ranges{0};
+
+        bb_co_range = positions_ranges{0};
+        bb_de_range = positions_ranges{5,10,15,20,25,30,35,40,45,50,60,70};
+        bb_sb_range = positions_ranges{5,10,15,20,25,30,35,40,45,50,60,70};
+        bb_co_de_range = positions_ranges{0};
+        bb_co_sb_range = positions_ranges{0};
+        bb_de_sb_range = positions_ranges{5,10,15,20,25,30,35,40,45,50,60,70};
+        bb_co_de_sb_range = positions_ranges{0};
+
+    } else if(pos == "co" || pos == "CO" || pos == "CutOff" || pos == "cutoff" || pos == "Cutoff"){
+        co_range = positions_ranges{15,20,25,30,35,40,45};
+
+        de_range = positions_ranges{0};
+        de_co_range = positions_ranges{5,10,15,20,25};
+
+        sb_range = positions_ranges{0};
+        sb_co_range = positions_ranges{5,10,15,20,25,30,35};
+        sb_de_range = positions_ranges{0};
+        sb_co_de_range = positions_ranges{5,10,15,20,25,30,35};
+
+        bb_co_range = positions_ranges{5,10,15,20,25,30,35};
+        bb_de_range = positions_ranges{0};
+        bb_sb_range = positions_ranges{0};
+        bb_co_de_range = positions_ranges{5,10,15,20,25,30,35};
+        bb_co_sb_range = positions_ranges{5,10,15,20,25,30,35};
+        bb_de_sb_range = positions_ranges{0};
+        bb_co_de_sb_range = positions_ranges{5,10,15,20,25,30,35};
+    } else if(pos == "sb" || pos == "SB" || pos == "SmallBlind" || pos == "smallblind" || pos == "Smallblind"){
+        co_range = positions_ranges{0};
+
+        de_range = positions_ranges{0};
+        de_co_range = positions_ranges{0};
+
+        sb_range = positions_ranges{5,10,15,20,25,30,35,40,45,50,60,70};
+        sb_co_range = positions_ranges{0};
+        sb_de_range = positions_ranges{0};
+        sb_co_de_range = positions_ranges{0};
+
+        bb_co_range = positions_ranges{0};
+        bb_de_range = positions_ranges{0};
+        bb_sb_range = positions_ranges{5,10,15,20,25,30,35,40,45,50,60,70};
+        bb_co_de_range = positions_ranges{0};
+        bb_co_sb_range = positions_ranges{0};
+        bb_de_sb_range = positions_ranges{0};
+        bb_co_de_sb_range = positions_ranges{0};
+    }
+    else{
+        co_range = positions_ranges{20,25,30};
+
+        de_range = positions_ranges{25,30,35};
+        de_co_range = positions_ranges{5,10,15};
+
+        sb_range = positions_ranges{50,60,70};
+        sb_co_range = positions_ranges{5,10,15};
+        sb_de_range = positions_ranges{10,15,20};
+        sb_co_de_range = positions_ranges{5,10,15};
+
+        bb_co_range = positions_ranges{20,25,30};
+        bb_de_range = positions_ranges{20,25,30};
+        bb_sb_range = positions_ranges{30,35,40};
+        bb_co_de_range = positions_ranges{10,15,20};
+        bb_co_sb_range = positions_ranges{10,15,20};
+        bb_de_sb_range = positions_ranges{15,20,25};
+        bb_co_de_sb_range = positions_ranges{5,10,15};
+    }
+
+}
+
+bool valid_params(char *argv[], int argc){
+    if(argc < 2 || argc > 3){
+        return false;
+    }
+
+    string algo;
+    if(argc == 2){
+        algo = argv[1];
+        if(algo == "MinMax" || algo == "MINMAX" || algo == "minmax" ||
+           algo == "Nash" || algo == "NASH" || algo == "nash" ||
+           algo == "BR" || algo == "br" || algo == "BestResponse" ){
+            return true;
+        }
+        return false;
+    }
+
+    string pos = argv[1];
+    algo = argv[2];
+    if(pos == "de" || pos == "DE" || pos == "Dealer" || pos == "dealer" ||
+       pos == "sb" || pos == "SB" || pos == "SmallBlind" || pos == "smallblind" || pos == "Smallblind" ||
+       pos == "co" || pos == "CO" || pos == "CutOff" || pos == "cutoff" || pos == "Cutoff"){
+
+        if(algo == "MinMax" || algo == "MINMAX" || algo == "minmax" ||
+           algo == "Nash" || algo == "NASH" || algo == "nash" ||
+           algo == "BR" || algo == "br" || algo == "BestResponse" ){
+            return true;
+        }
+        return false;
+    }
+
+    return false;
+
+}
+
+void print_help(){
+    cout << "--Help: keep format of <position> <algorithm> as input " << endl;
+    cout << "        algorithms: Nash, MinMax, BR (iterated best response)" << endl;
+    cout << "        convert <equity|frequency> <input.txt> <output.bin>   convert a data file to a binary table file" << endl;
+    cout << "        merge <position> <algorithm> [options] <file>...   the Nash or MinMax results of the --checkpoint files of" << endl;
+    cout << "                                  every --shard, run with the same options as the shards" << endl;
+    cout << "        serve [--socket <path>]   load the data once and answer json solve requests, one per line, from stdin" << endl;
+    cout << "                                  (or a unix socket), e.g. {\"id\":1,\"position\":\"sb\",\"algorithm\":\"minmax\"," << endl;
+    cout << "                                  \"small_blind\":0.05,\"big_blind\":0.1,\"ranges\":{\"sb\":[5,10],\"bb_sb\":[5,10]}}" << endl;
+    cout << "        options: --threads N   number of worker threads for the Nash and MinMax sweeps (0 - all cores)" << endl;
+    cout << "                 --equity-file <path>      equity data file (env " EQUITY_DATA_FILE_ENV ", default " EQUITY_DATA_FILE ")" << endl;
+    cout << "                 --frequency-file <path>   frequency data file (env " FREQUENCY_DATA_FILE_ENV ", default " FREQUENCY_DATA_FILE ")" << endl;
+    cout << "                 --blinds <path>   solve every \"all_in, small_blind, big_blind\" line of the file (default 1, 0.05, 0.1)," << endl;
+    cout << "                                   the tables are loaded once and MinMax sweeps all of them together; the blinds" << endl;
+    cout << "                                   must be positive and at most the all in" << endl;
+    cout << "                 --payoff-cache <path>   read the all in and blinds coefficients of every profile from the file, building" << endl;
+    cout << "                                         and writing it first when it is missing or was made for other data or ranges" << endl;
+    cout << "                 --results <path>   write every Nash point to a csv as it is confirmed, with its values and margin" << endl;
+    cout << "                 --top K   keep and print only the K Nash points of least margin (default all, none with --results)" << endl;
+    cout << "                 --checkpoint <path>   save the Nash and MinMax sweeps to the file every few minutes and when they end" << endl;
+    cout << "                 --checkpoint-interval S   seconds between two checkpoints (default " << CHECKPOINT_INTERVAL_S << ")" << endl;
+    cout << "                 --resume   continue the sweep saved in the --checkpoint file instead of starting over" << endl;
+    cout << "                 --shard i/N   sweep only the i-th (0 to N-1) of N parts of the Nash or MinMax sweep into the" << endl;
+    cout << "                               --checkpoint file, the parts can run in separate processes or machines" << endl;
+    cout << "                 --max-profiles N   serve refuses requests of more profiles (default " << SERVE_MAX_PROFILES << ")" << endl;
+    cout << "                 --max-candidates N   Nash keeps at most N profiles of the sweep in memory for the margin pass, which" << endl;
+    cout << "                                      sweeps the space again when it needs the ones left out (default " << NASH_CANDIDATES_MAX << ")" << endl;
+    cout << "                 --range-step N   every N-th range from the smallest to the largest one of each preset axis, ranges" << endl;
+    cout << "                                  and of serve requests between the buckets of the data files are interpolated" << endl;
+    cout << "                 --progress / --no-progress   progress, rate and ETA of the sweeps (default: on when the log is a terminal)" << endl;
+    cout << "                 --stats <path>   write phase timings, evaluation counters and peak RSS as json at exit (- for stderr)" << endl;
+    cout << "                 --prune   drop the ranges that are strictly dominated for their position before Nash and BR" << endl;
+    cout << "                 --prune-epsilon E   --prune, also dropping a range when another one is never more than E worse" << endl;
+}
+
+void write_table_file(const string & path, table_kind kind, const range_buckets & buckets, uint32_t values_num, const double * data,
+        const struct stat & source){
+    // written next to the file and renamed over it, the runs that have the old one mapped keep reading the old one
+    const string temporary = path + ".tmp";
+    ofstream myfile(temporary, ios::binary | ios::trunc);
+    if(!myfile.is_open()){
+        cout << "-E- failed to open " << temporary << " for writing" << endl;
+        throw exception();
+    }
+
+    const uint32_t buckets_num = buckets.values.size();
+    table_file_header header = table_file_header();
+    memcpy(header.magic, TABLE_FILE_MAGIC, sizeof(header.magic));
+    header.version = TABLE_FILE_VERSION;
+    header.byte_order = TABLE_FILE_BYTE_ORDER;
+    header.kind = kind;
+    header.buckets_num = buckets_num;
+    header.values_num = values_num;
+    header.source_size = source.st_size;
+    header.source_mtime = source.st_mtim.tv_sec * 1000000000ll + source.st_mtim.tv_nsec;
+    // the table starts on a cache line so the mapped doubles are aligned
+    header.data_offset = (sizeof(header) + sizeof(int32_t) * (buckets_num + values_num) + 63) / 64 * 64;
+    myfile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    for(auto range : buckets.values){
+        int32_t value = range;
+        myfile.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+    for(uint32_t i = 0; i < values_num; i++){
+        int32_t value = i;
+        myfile.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+    const string padding(header.data_offset - sizeof(header) - sizeof(int32_t) * (buckets_num + values_num), '\0');
+    myfile.write(padding.data(), padding.size());
+
+    const uint64_t entries = (uint64_t)buckets_num * buckets_num * buckets_num * buckets_num * values_num;
+    myfile.write(reinterpret_cast<const char *>(data), entries * sizeof(double));
+    myfile.close();
+    if(!myfile || rename(temporary.c_str(), path.c_str()) != 0){
+        cout << "-E- failed to write " << path << endl;
+        throw exception();
+    }
+}
+
+bool is_table_file(const string & path){
+    ifstream myfile(path, ios::binary);
+    char magic[sizeof(table_file_header::magic)];
+    return myfile.read(magic, sizeof(magic)) && memcmp(magic, TABLE_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+const double * map_table_file(const string & path, table_kind kind, range_buckets & buckets, uint32_t values_num,
+        shared_ptr<const void> & storage){
+    shared_ptr<mapped_file> file = map_file(path);
+    if(!file || file->size < sizeof(table_file_header)){
+        cout << "-E- failed to map table file " << path << ", Exiting..." << endl;
+        throw exception();
+    }
+
+    const char * base = static_cast<const char *>(file->data);
+    const table_file_header & header = *reinterpret_cast<const table_file_header *>(base);
+    // a range has at most one bucket, so n^4 * values_num fits in 64 bits whatever the file says; the data offset is
+    // bounded by the file before any arithmetic on it
+    const uint64_t n = min<uint64_t>(header.buckets_num, MAX_RANGE + 2), entries = n * n * n * n * values_num;
+    if(memcmp(header.magic, TABLE_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != TABLE_FILE_VERSION ||
+       header.buckets_num > MAX_RANGE + 1 ||
+       header.byte_order != TABLE_FILE_BYTE_ORDER || header.kind != (uint32_t)kind || header.values_num != values_num ||
+       header.data_offset % sizeof(double) != 0 || header.data_offset < sizeof(header) + sizeof(int32_t) * (n + values_num) ||
+       header.data_offset > file->size || entries > (file->size - header.data_offset) / sizeof(double)){
+        cout << "-E- invalid table file " << path << " (version " << header.version << ", kind " << header.kind << ")" << endl;
+        throw exception();
+    }
+
+    const int32_t * axes = reinterpret_cast<const int32_t *>(base + sizeof(header));
+    vector<bool> present(MAX_RANGE + 1, false);
+    for(uint64_t i = 0; i < n; i++){
+        if(axes[i] < 0 || axes[i] > MAX_RANGE || (i > 0 && axes[i] <= axes[i - 1])){
+            cout << "-E- invalid range bucket in table file " << path << ": " << axes[i] << endl;
+            throw exception();
+        }
+        present[axes[i]] = true;
+    }
+    for(uint32_t i = 0; i < values_num; i++){
+        if(axes[n + i] != (int32_t)i){
+            cout << "-E- unexpected value axis in table file " << path << endl;
+            throw exception();
+        }
+    }
+    buckets = build_range_buckets(present);
+
+    storage = file;
+    return reinterpret_cast<const double *>(base + header.data_offset);
+}
+
+ranges_equity_table load_ranges_equity_table(const string & path){
+    auto start = chrono::steady_clock::now();
+    if(!is_table_file(path)){
+        const map_ranges_equity map = read_ranges_equity_file(path);
+        record_phase("load", start);
+        start = chrono::steady_clock::now();
+        ranges_equity_table table = build_ranges_equity_table(map);
+        record_phase("index_build", start);
+        return table;
+    }
+    static_assert(sizeof(positions_equity) == POSITIONS_NUM * sizeof(double), "positions_equity must be 4 packed doubles");
+    ranges_equity_table table;
+    table.equities = reinterpret_cast<const positions_equity *>(
+            map_table_file(path, equity_table_kind, table.buckets[0], POSITIONS_NUM, table.storage));
+    fill(table.buckets + 1, table.buckets + POSITIONS_NUM, table.buckets[0]);
+    record_phase("load", start);
+    cout << "-I- ranges equity table mapped from " << path << ": " << table.buckets[0].values.size() << " range buckets" << endl;
+    return table;
+}
+
+scenario_probability_table load_scenario_probability_table(const string & path){
+    auto start = chrono::steady_clock::now();
+    if(!is_table_file(path)){
+        const map_scenario_probability map = read_scenario_probability_file(path);
+        record_phase("load", start);
+        start = chrono::steady_clock::now();
+        scenario_probability_table table = build_scenario_probability_table(map);
+        record_phase("index_build", start);
+        return table;
+    }
+    scenario_probability_table table;
+    table.probabilities = map_table_file(path, probability_table_kind, table.buckets[0], SCENARIOS_NUM, table.storage);
+    fill(table.buckets + 1, table.buckets + POSITIONS_NUM, table.buckets[0]);
+    record_phase("load", start);
+    cout << "-I- scenario probability table mapped from " << path << ": " << table.buckets[0].values.size() << " range buckets" << endl;
+    return table;
+}
+
+string table_file_path(const string & text_path){
+    string bin_path = text_path;
+    if(bin_path.size() <= 4 || bin_path.compare(bin_path.size() - 4, 4, ".txt") != 0){
+        return text_path;
+    }
+    bin_path.replace(bin_path.size() - 4, 4, ".bin");
+    if(access(bin_path.c_str(), R_OK) != 0){
+        return text_path;
+    }
+
+    // without the text file the binary one is all there is, otherwise it has to be converted from the text as it is now
+    struct stat source;
+    if(stat(text_path.c_str(), &source) != 0){
+        return bin_path;
+    }
+    table_file_header header = table_file_header();
+    ifstream myfile(bin_path, ios::binary);
+    myfile.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if(myfile && memcmp(header.magic, TABLE_FILE_MAGIC, sizeof(header.magic)) == 0 && header.version == TABLE_FILE_VERSION &&
+       header.source_size == (uint64_t)source.st_size &&
+       header.source_mtime == source.st_mtim.tv_sec * 1000000000ll + source.st_mtim.tv_nsec){
+        return bin_path;
+    }
+    if(!myfile || memcmp(header.magic, TABLE_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+       (header.kind != equity_table_kind && header.kind != probability_table_kind)){
+        cout << "-I- " << bin_path << " is not a table file, reading " << text_path << endl;
+        return text_path;
+    }
+    cout << "-I- " << bin_path << " was not converted from " << text_path << " as it is now, rebuilding it" << endl;
+    convert_data_file(table_kind(header.kind), text_path, bin_path);
+    return bin_path;
+}
+
+int convert_table_file(int argc, char *argv[]){
+    string kind = argc == 5 ? argv[2] : "";
+    if(kind != "equity" && kind != "frequency"){
+        print_help();
+        return 1;
+    }
+    convert_data_file(kind == "equity" ? equity_table_kind : probability_table_kind, argv[3], argv[4]);
+    return 0;
+}
+
+void convert_data_file(table_kind kind, const string & text_path, const string & bin_path){
+    struct stat source;
+    if(stat(text_path.c_str(), &source) != 0){
+        cout << "-E- failed to open " << text_path << endl;
+        throw exception();
+    }
+    if(kind == equity_table_kind){
+        ranges_equity_table table = build_ranges_equity_table(read_ranges_equity_file(text_path));
+        const size_t n = table.buckets[0].values.size();
+        write_table_file(bin_path, equity_table_kind, table.buckets[0], POSITIONS_NUM, table.equities[0].data(), source);
+        cout << "-I- wrote " << n * n * n * n << " equity entries to " << bin_path << endl;
+    } else{
+        scenario_probability_table table = build_scenario_probability_table(read_scenario_probability_file(text_path));
+        const size_t n = table.buckets[0].values.size();
+        write_table_file(bin_path, probability_table_kind, table.buckets[0], SCENARIOS_NUM, table.probabilities, source);
+        cout << "-I- wrote " << n * n * n * n * SCENARIOS_NUM << " probability entries to " << bin_path << endl;
+    }
+}
+
+int parse_options(int argc, char *argv[], run_options & options){
+    if(const char * path = getenv(EQUITY_DATA_FILE_ENV)){
+        options.equity_file = path;
+    }
+    if(const char * path = getenv(FREQUENCY_DATA_FILE_ENV)){
+        options.frequency_file = path;
+    }
+
+    int positional = 1;
+    for(int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if(arg == "--equity-file" || arg == "--frequency-file" || arg == "--socket" || arg == "--stats" || arg == "--blinds" ||
+           arg == "--payoff-cache" || arg == "--results" || arg == "--checkpoint"){
+            if(i + 1 >= argc){
+                cout << "-E- missing value of " << arg << endl;
+                return -1;
+            }
+            string & path = arg == "--equity-file" ? options.equity_file :
+                            arg == "--frequency-file" ? options.frequency_file :
+                            arg == "--socket" ? options.socket_path :
+                            arg == "--blinds" ? options.blinds_file :
+                            arg == "--payoff-cache" ? options.payoff_file :
+                            arg == "--results" ? options.results_file :
+                            arg == "--checkpoint" ? options.checkpoint_file : stats.path;
+            path = argv[++i];
+        } else if(arg == "--progress" || arg == "--no-progress"){
+            options.progress = arg == "--progress";
+        } else if(arg == "--prune"){
+            options.prune = true;
+        } else if(arg == "--resume"){
+            options.resume = true;
+        } else if(arg == "--prune-epsilon"){
+            if(i + 1 >= argc){
+                cout << "-E- missing value of " << arg << endl;
+                return -1;
+            }
+            char * end;
+            double epsilon = strtod(argv[++i], &end);
+            if(*end != '\0' || !(epsilon >= 0)){
+                cout << "-E- invalid value of " << arg << ": " << argv[i] << endl;
+                return -1;
+            }
+            options.prune = true;
+            options.prune_epsilon = epsilon;
+        } else if(arg == "--top"){
+            if(i + 1 >= argc){
+                cout << "-E- missing value of " << arg << endl;
+                return -1;
+            }
+            char * end;
+            long top = strtol(argv[++i], &end, 10);
+            if(*end != '\0' || top <= 0){
+                cout << "-E- invalid value of " << arg << ": " << argv[i] << endl;
+                return -1;
+            }
+            options.top = top;
+        } else if(arg == "--range-step"){
+            if(i + 1 >= argc){
+                cout << "-E- missing value of " << arg << endl;
+                return -1;
+            }
+            char * end;
+            long step = strtol(argv[++i], &end, 10);
+            if(*end != '\0' || step <= 0 || step > MAX_RANGE){
+                cout << "-E- invalid value of " << arg << ": " << argv[i] << endl;
+                return -1;
+            }
+            options.range_step = step;
+        } else if(arg == "--shard"){
+            if(i + 1 >= argc){
+                cout << "-E- missing value of " << arg << endl;
+                return -1;
+            }
+            char * end;
+            long shard = strtol(argv[++i], &end, 10), shards = 0;
+            if(*end == '/'){
+                shards = strtol(end + 1, &end, 10);
+            }
+            if(*end != '\0' || shard < 0 || shards <= 0 || shard >= shards){
+                cout << "-E- invalid value of " << arg << ": " << argv[i] << endl;
+                return -1;
+            }
+            options.shard = shard;
+            options.shards = shards;
+        } else if(arg == "--max-profiles"){
+            if(i + 1 >= argc){
+                cout << "-E- missing value of " << arg << endl;
+                return -1;
+            }
+            char * end;
+            errno = 0;
+            unsigned long long profiles = strtoull(argv[++i], &end, 10);
+            if(*end != '\0' || argv[i][0] == '-' || profiles == 0 || errno == ERANGE){
+                cout << "-E- invalid value of " << arg << ": " << argv[i] << endl;
+                return -1;
+            }
+            options.max_profiles = profiles;
+        } else if(arg == "--max-candidates"){
+            if(i + 1 >= argc){
+                cout << "-E- missing value of " << arg << endl;
+                return -1;
+            }
+            char * end;
+            errno = 0;
+            unsigned long long candidates = strtoull(argv[++i], &end, 10);
+            if(*end != '\0' || argv[i][0] == '-' || candidates == 0 || errno == ERANGE){
+                cout << "-E- invalid value of " << arg << ": " << argv[i] << endl;
+                return -1;
+            }
+            options.max_candidates = candidates;
+        } else if(arg == "--checkpoint-interval"){
+            if(i + 1 >= argc){
+                cout << "-E- missing value of " << arg << endl;
+                return -1;
+            }
+            char * end;
+            long interval = strtol(argv[++i], &end, 10);
+            if(*end != '\0' || interval <= 0){
+                cout << "-E- invalid value of " << arg << ": " << argv[i] << endl;
+                return -1;
+            }
+            options.checkpoint_interval = interval;
+        } else if(arg == "--threads"){
+            if(i + 1 >= argc){
+                cout << "-E- missing value of " << arg << endl;
+                return -1;
+            }
+            char * end;
+            long threads = strtol(argv[++i], &end, 10);
+            if(*end != '\0' || threads < 0){
+                cout << "-E- invalid value of " << arg << ": " << argv[i] << endl;
+                return -1;
+            }
+            options.threads = threads ? threads : max(1u, thread::hardware_concurrency());
+        } else if(arg.compare(0, 2, "--") == 0){
+            cout << "-E- unknown option: " << arg << endl;
+            return -1;
+        } else{
+            argv[positional++] = argv[i];
+        }
+    }
+    if(options.resume && options.checkpoint_file.empty()){
+        cout << "-E- --resume needs --checkpoint <path>" << endl;
+        return -1;
+    }
+    if(options.shards > 1 && options.checkpoint_file.empty()){
+        cout << "-E- --shard needs --checkpoint <path> for the partial results of the shard" << endl;
+        return -1;
+    }
+    return positional;
+}
+
+strategy_space make_strategy_space(positions_ranges & co_range, positions_ranges & de_range, positions_ranges & de_co_range,
+        positions_ranges & sb_range, positions_ranges & sb_co_range, positions_ranges & sb_de_range, positions_ranges & sb_co_de_range,
+        positions_ranges & bb_co_range, positions_ranges & bb_de_range, positions_ranges & bb_sb_range,
+        positions_ranges & bb_co_de_range, positions_ranges & bb_co_sb_range, positions_ranges & bb_de_sb_range, positions_ranges & bb_co_de_sb_range){
+    return strategy_space{{co_range, de_range, de_co_range, sb_range, sb_co_range, sb_de_range, sb_co_de_range,
+                           bb_co_range, bb_de_range, bb_sb_range, bb_co_de_range, bb_co_sb_range, bb_de_sb_range, bb_co_de_sb_range}};
+}
+
+uint64_t strategy_space_size(const strategy_space & space, int first_axis, int last_axis){
+    uint64_t size = 1;
+    for(int axis = first_axis; axis < last_axis; axis++){
+        size *= space.axes[axis].size();
+    }
+    return size;
+}
+
+bool checked_space_size(const strategy_space & space, uint64_t & size){
+    size = 1;
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        if(__builtin_mul_overflow(size, (uint64_t)space.axes[axis].size(), &size)){
+            return false;
+        }
+    }
+    return true;
+}
+
+void cursor_seek(const strategy_space & space, strategy_cursor & cursor, uint64_t position, int first_axis, int last_axis){
+    for(int axis = last_axis - 1; axis >= first_axis; axis--){
+        const uint64_t size = space.axes[axis].size();
+        cursor.index[axis] = position % size;
+        cursor.profile.*strategy_axes[axis] = space.axes[axis][cursor.index[axis]];
+        position /= size;
+    }
+}
+
+int cursor_next(const strategy_space & space, strategy_cursor & cursor, int first_axis, int last_axis){
+    // returns the outermost axis that changed, or -1 after wrapping around past the last profile
+    for(int axis = last_axis - 1; axis >= first_axis; axis--){
+        if(++cursor.index[axis] < (int)space.axes[axis].size()){
+            cursor.profile.*strategy_axes[axis] = space.axes[axis][cursor.index[axis]];
+            return axis;
+        }
+        cursor.index[axis] = 0;
+        cursor.profile.*strategy_axes[axis] = space.axes[axis][0];
+    }
+    return -1;
+}
+
+position_strategy strategy_of(const strategy_profile & profile){
+    position_strategy strategy(STRATEGY_AXES_NUM);
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        strategy[axis] = profile.*strategy_axes[axis];
+    }
+    return strategy;
+}
+
+uint64_t strategy_chunk_size(const strategy_space & space, unsigned threads, bool saved){
+    // a chunk is one combination of the outer loops, with enough outer combinations to keep every thread busy, or to
+    // save a sweep often enough
+    const uint64_t min_chunks = saved ? SWEEP_FILE_MIN_CHUNKS : threads > 1 ? 64 * (uint64_t)threads : 1;
+    int split_axis = 0;
+    while(split_axis < STRATEGY_AXES_NUM && strategy_space_size(space, 0, split_axis) < min_chunks){
+        split_axis++;
+    }
+    return strategy_space_size(space, split_axis, STRATEGY_AXES_NUM);
+}
+
+void run_chunks(uint64_t chunks, unsigned threads, const function<void(unsigned, uint64_t)> & work){
+    if(threads <= 1){
+        for(uint64_t chunk = 0; chunk < chunks; chunk++){
+            work(0, chunk);
+        }
+        return;
+    }
+
+    // every worker owns a contiguous run of chunks, takes from its front and steals the back half of another run
+    struct chunk_queue {
+        mutex lock;
+        uint64_t next, end;
+    };
+    vector<chunk_queue> queues(threads);
+    for(unsigned worker = 0; worker < threads; worker++){
+        queues[worker].next = chunks * worker / threads;
+        queues[worker].end = chunks * (worker + 1) / threads;
+    }
+
+    atomic<bool> failed(false);
+    exception_ptr error;
+    mutex error_lock;
+
+    auto run_worker = [&](unsigned worker){
+        chunk_queue & own = queues[worker];
+        while(!failed){
+            uint64_t chunk = 0;
+            bool found = false;
+            {
+                lock_guard<mutex> guard(own.lock);
+                if(own.next < own.end){
+                    chunk = own.next++;
+                    found = true;
+                }
+            }
+
+            for(unsigned i = 1; !found && i < threads; i++){
+                chunk_queue & victim = queues[(worker + i) % threads];
+                uint64_t stolen_next, stolen_end;
+                {
+                    lock_guard<mutex> guard(victim.lock);
+                    if(victim.next >= victim.end){
+                        continue;
+                    }
+                    stolen_next = victim.next + (victim.end - victim.next) / 2;
+                    stolen_end = victim.end;
+                    victim.end = stolen_next;
+                }
+                lock_guard<mutex> guard(own.lock);
+                chunk = stolen_next;
+                own.next = stolen_next + 1;
+                own.end = stolen_end;
+                found = true;
+            }
+            if(!found){
+                return;
+            }
+
+            try {
+                work(worker, chunk);
+            }
+            catch (...) {
+                lock_guard<mutex> guard(error_lock);
+                if(!error){
+                    error = current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+
+    vector<thread> pool;
+    for(unsigned worker = 1; worker < threads; worker++){
+        pool.emplace_back(run_worker, worker);
+    }
+    run_worker(0);
+    for(auto & worker : pool){
+        worker.join();
+    }
+    if(error){
+        rethrow_exception(error);
+    }
+}
+
+uint64_t find_maximal_strategy(const strategy_space & space, int seat, const vector<double> & values){
+    // values.size() when none is above -100; the strategies are compared only on ties, the dense order follows the
+    // order the ranges were given in
+    double max = -100;
+    uint64_t max_strategy = values.size();
+    for(uint64_t strategy = 0; strategy < values.size(); strategy++){
+        if(values[strategy] > max ||
+           (values[strategy] == max && max_strategy < values.size() &&
+            seat_strategy(space, seat, strategy) < seat_strategy(space, seat, max_strategy))){
+            max_strategy = strategy;
+            max = values[strategy];
+        }
+    }
+    return max_strategy;
+}
+
+
+vector<position_strategy> calc_min_max(const ranges_equity_table & ranges_equity, const scenario_probability_table & scenario_probability, double AllIn, double SmallBlind, double BigBlind,
+        unsigned threads, positions_ranges & co_range, positions_ranges & de_range, positions_ranges & de_co_range,
+        positions_ranges & sb_range, positions_ranges & sb_co_range, positions_ranges & sb_de_range, positions_ranges & sb_co_de_range,
+        positions_ranges & bb_co_range, positions_ranges & bb_de_range, positions_ranges & bb_sb_range,
+        positions_ranges & bb_co_de_range, positions_ranges & bb_co_sb_range, positions_ranges & bb_de_sb_range, positions_ranges & bb_co_de_sb_range){
+    return calc_min_max_batch(ranges_equity, scenario_probability, vector<blind_config>{blind_config{AllIn, SmallBlind, BigBlind}}, threads,
+                              co_range, de_range, de_co_range, sb_range, sb_co_range, sb_de_range, sb_co_de_range, bb_co_range, bb_de_range,
+                              bb_sb_range, bb_co_de_range, bb_co_sb_range, bb_de_sb_range, bb_co_de_sb_range)[0];
+}
+
+vector<vector<position_strategy> > calc_min_max_batch(const ranges_equity_table & ranges_equity,
+        const scenario_probability_table & scenario_probability, const vector<blind_config> & configs,
+        unsigned threads, positions_ranges & co_range, positions_ranges & de_range, positions_ranges & de_co_range,
+        positions_ranges & sb_range, positions_ranges & sb_co_range, positions_ranges & sb_de_range, positions_ranges & sb_co_de_range,
+        positions_ranges & bb_co_range, positions_ranges & bb_de_range, positions_ranges & bb_sb_range,
+        positions_ranges & bb_co_de_range, positions_ranges & bb_co_sb_range, positions_ranges & bb_de_sb_range, positions_ranges & bb_co_de_sb_range,
+        const payoff_table * payoffs, const sweep_checkpoint * checkpoint){
+
+    const strategy_space space = make_strategy_space(co_range, de_range, de_co_range, sb_range, sb_co_range, sb_de_range, sb_co_de_range,
+                                                     bb_co_range, bb_de_range, bb_sb_range, bb_co_de_range, bb_co_sb_range, bb_de_sb_range, bb_co_de_sb_range);
+    const bool saved = checkpoint && (!checkpoint->path.empty() || !checkpoint->merge_files.empty());
+    const uint64_t total_iter = strategy_space_size(space, 0, STRATEGY_AXES_NUM),
+            chunk_size = strategy_chunk_size(space, threads, saved), chunks = total_iter / chunk_size;
+    const size_t configs_num = configs.size();
+
+    // every thread folds into its own dense minimum table per configuration and position, indexed by the position's own strategy
+    vector<vector<array<vector<double>, POSITIONS_NUM> > > thread_min_values(threads, vector<array<vector<double>, POSITIONS_NUM> >(configs_num));
+    for(auto & config_min_values : thread_min_values){
+        for(auto & min_values : config_min_values){
+            for(int seat = 0; seat < POSITIONS_NUM; seat++){
+                min_values[seat].assign(strategy_space_size(space, seat_axes[seat], seat_axes[seat + 1]), 100);
+            }
+        }
+    }
+    progress_meter progress;
+
+    cout << "-I- Starting calculation of min max algorithm..." << endl;
+    if(configs_num > 1){
+        cout << "-I- Blind configurations: " << configs_num << ", one sweep for all of them" << endl;
+    }
+    if(threads > 1){
+        cout << "-I- Threads: " << threads << ", chunks: " << chunks << " of " << chunk_size << " iterations" << endl;
+    }
+    auto start = chrono::steady_clock::now();
+
+    // a resumed sweep folds into worker 0's tables, they are a minimum over the chunks like any other
+    sweep_saver saver;
+    sweep_state resumed;
+    const vector<uint64_t> pending = start_sweep_saver(saver, checkpoint,
+            make_sweep_header(min_max_sweep_kind, space, configs_num, saved ? tables_fingerprint(ranges_equity, scenario_probability) : 0,
+                              chunks, payoffs, 0), space, configs, threads, resumed);
+    if(!resumed.min_values.empty()){
+        thread_min_values[0] = resumed.min_values;
+    }
+    auto add_worker = [&](unsigned worker, sweep_state & state){
+        if(state.min_values.empty()){
+            state.min_values = thread_min_values[worker];
+            return;
+        }
+        for(size_t config = 0; config < configs_num; config++){
+            for(int seat = 0; seat < POSITIONS_NUM; seat++){
+                vector<double> & min_values = state.min_values[config][seat];
+                for(size_t i = 0; i < min_values.size(); i++){
+                    min_values[i] = min(min_values[i], thread_min_values[worker][config][seat][i]);
+                }
+            }
+        }
+    };
+    start_progress(progress, "min max sweep", "profiles", pending.size() * chunk_size);
+    // the values of a chunk are staged in batches over its innermost big blind axes
+    const int batch_axis = batch_first_axis(space, seat_axes[3], STRATEGY_AXES_NUM, min<uint64_t>(chunk_size, BATCH_MAX_PROFILES));
+
+    run_chunks(pending.size(), threads, [&](unsigned worker, uint64_t index){
+        const uint64_t chunk = pending[index];
+        unique_lock<mutex> guard(saver.worker_locks[worker]);
+        vector<array<vector<double>, POSITIONS_NUM> > & config_min_values = thread_min_values[worker];
+        vector<staged_batch> batches;
+        for(const blind_config & config : configs){
+            batches.push_back(make_staged_batch(make_staged_evaluator(config.all_in, config.big_blind, config.small_blind, ranges_equity,
+                                                                      scenario_probability),
+                                                space, batch_axis, STRATEGY_AXES_NUM, 0, POSITIONS_NUM));
+        }
+        strategy_cursor cursor;
+        cursor_seek(space, cursor, chunk * chunk_size, 0, STRATEGY_AXES_NUM);
+        uint64_t evaluations = 0;
+        for(uint64_t i = 0; i < chunk_size; i++, cursor_next(space, cursor, 0, STRATEGY_AXES_NUM)){
+            const payoff_coefficients * coefficients = nullptr;
+            if(payoffs){
+                coefficients = &payoffs->coefficients[pack_profile(payoffs->packer, cursor.profile)];
+            } else if(i % batches[0].size == 0){
+                stage_batch(batches[0], cursor.profile);
+                for(size_t config = 1; config < configs_num; config++){
+                    restage_batch_blinds(batches[config], batches[0]);
+                }
+            }
+            for(size_t config = 0; config < configs_num; config++){
+                const positions_values e = coefficients ? payoff_value(*coefficients, configs[config]) :
+                                           batch_value(batches[config], i % batches[config].size);
+                evaluations++;
+
+                array<vector<double>, POSITIONS_NUM> & min_values = config_min_values[config];
+                for(int seat = 0; seat < POSITIONS_NUM; seat++){
+                    double & min_value = min_values[seat][seat_strategy_index(space, cursor, seat)];
+                    if(e[seat] < min_value){
+                        min_value = e[seat];
+                    }
+                }
+            }
+        }
+        saver.worker_chunks[worker].push_back(chunk);
+        guard.unlock();
+        stats.sweep_profiles += chunk_size;
+        stats.profile_evaluations += evaluations;
+        report_progress(progress, chunk_size);
+        save_checkpoint(saver, false, add_worker);
+    });
+    finish_progress(progress);
+    save_checkpoint(saver, true, add_worker);
+    record_phase("sweep", start);
+    vector<vector<position_strategy> > results;
+    if(checkpoint && checkpoint->shards > 1){
+        cout << "-I- Shard done, merge " << saver.path << " with the other shards for the results" << endl;
+        return results;
+    }
+    start = chrono::steady_clock::now();
+
+    for(size_t config = 0; config < configs_num; config++){
+        // element-wise min of the thread tables, done after the workers joined so it needs no locking
+        array<vector<double>, POSITIONS_NUM> & min_values = thread_min_values[0][config];
+        for(unsigned worker = 1; worker < threads; worker++){
+            for(int seat = 0; seat < POSITIONS_NUM; seat++){
+                for(size_t i = 0; i < min_values[seat].size(); i++){
+                    if(thread_min_values[worker][config][seat][i] < min_values[seat][i]){
+                        min_values[seat][i] = thread_min_values[worker][config][seat][i];
+                    }
+                }
+            }
+        }
+
+        if(configs_num > 1){
+            cout << "-I- Blinds: all in " << configs[config].all_in << ", small blind " << configs[config].small_blind
+                 << ", big blind " << configs[config].big_blind << endl;
+        }
+        const char * const seat_names[POSITIONS_NUM] = {"CO", "DE", "SB", "BB"};
+        vector<position_strategy> result;
+        for(int seat = 0; seat < POSITIONS_NUM; seat++){
+            const uint64_t max_strategy = find_maximal_strategy(space, seat, min_values[seat]);
+            const bool found = max_strategy < min_values[seat].size();
+            result.push_back(found ? seat_strategy(space, seat, max_strategy) : position_strategy());
+            cout << seat_names[seat] << " result: " << endl;
+            for(auto i : result.back())
+                cout << i << ", ";
+            cout << endl;
+            cout << (found ? min_values[seat][max_strategy] : 0) << endl;
+        }
+
+        results.push_back(result);
+    }
+
+    record_phase("result_extraction", start);
+    return results;
+}
+
+vector<blind_config> read_blind_configs(const string & path){
+    vector<blind_config> configs;
+
+    // all_in, small_blind, big_blind
+    parse_data_file(path, "blinds", [&](text_scanner & scanner){
+        blind_config config;
+        if(!(scan_double(scanner, config.all_in) && scan_char(scanner, ',') && scan_double(scanner, config.small_blind) &&
+             scan_char(scanner, ',') && scan_double(scanner, config.big_blind) && scan_line_end(scanner)) ||
+           !valid_blinds(config)){
+            return false;
+        }
+        configs.push_back(config);
+        return true;
+    });
+
+    if(configs.empty()){
+        cout << "-E- no blind configuration in " << path << endl;
+        throw exception();
+    }
+    return configs;
+}
+
+bool valid_blinds(const blind_config & blinds){
+    return std::isfinite(blinds.all_in) && std::isfinite(blinds.small_blind) && std::isfinite(blinds.big_blind) &&
+           blinds.all_in > 0 && blinds.small_blind > 0 && blinds.big_blind > 0 &&
+           blinds.small_blind <= blinds.all_in && blinds.big_blind <= blinds.all_in;
+}
+
+void start_progress(progress_meter & meter, const string & name, const string & unit, uint64_t total){
+    meter.name = name;
+    meter.unit = unit;
+    meter.total = max<uint64_t>(total, 1);
+    meter.start = chrono::steady_clock::now();
+    if(!progress_output){
+        return;
+    }
+
+    meter.reporter = thread([&meter]{
+        auto print = [&](bool last){
+            const uint64_t done = min(meter.done.load(memory_order_relaxed), meter.total);
+            const double seconds = chrono::duration<double>(chrono::steady_clock::now() - meter.start).count();
+            const double rate = seconds > 0 ? done / seconds : 0;
+            cout << "\r-I- " << meter.name << ": " << 100 * done / meter.total << "%, " << uint64_t(rate) << " " << meter.unit << "/sec";
+            if(!last && rate > 0){
+                const uint64_t eta = (meter.total - done) / rate;
+                cout << ", ETA " << eta / 3600 << ":" << setfill('0') << setw(2) << eta / 60 % 60 << ":" << setw(2) << eta % 60
+                     << setfill(' ');
+            }
+            cout << (last ? "\n" : "      ") << flush;
+        };
+        unique_lock<mutex> guard(meter.lock);
+        while(!meter.wake.wait_for(guard, chrono::milliseconds(PROGRESS_INTERVAL_MS), [&]{ return meter.finished; })){
+            print(false);
+        }
+        print(true);
+    });
+}
+
+void report_progress(progress_meter & meter, uint64_t step){
+    meter.done.fetch_add(step, memory_order_relaxed);
+}
+
+void finish_progress(progress_meter & meter){
+    if(!meter.reporter.joinable()){
+        return;
+    }
+    {
+        lock_guard<mutex> guard(meter.lock);
+        meter.finished = true;
+    }
+    meter.wake.notify_one();
+    meter.reporter.join();
+}
+
+progress_meter::~progress_meter(){
+    finish_progress(*this);
+}
+
+uint64_t seat_strategy_index(const strategy_space & space, const strategy_cursor & cursor, int seat){
+    uint64_t index = 0;
+    for(int axis = seat_axes[seat]; axis < seat_axes[seat + 1]; axis++){
+        index = index * space.axes[axis].size() + cursor.index[axis];
+    }
+    return index;
+}
+
+position_strategy seat_strategy(const strategy_space & space, int seat, uint64_t index){
+    strategy_cursor cursor;
+    cursor_seek(space, cursor, index, seat_axes[seat], seat_axes[seat + 1]);
+    position_strategy strategy;
+    for(int axis = seat_axes[seat]; axis < seat_axes[seat + 1]; axis++){
+        strategy.push_back(cursor.profile.*strategy_axes[axis]);
+    }
+    return strategy;
+}
+
+template <typename Exceeds>
+double best_deviation_value(deviation_engine & engine, const strategy_space & space, const strategy_profile & profile, int seat,
+        Exceeds exceeds){
+    // the deviations of a position only depend on the other positions, consecutive profiles of a sweep mostly share them
+    // for the innermost positions
+    strategy_profile & staged = engine.staged[seat];
+    if(engine.complete[seat]){
+        strategy_profile opponents = profile;
+        for(int axis = seat_axes[seat]; axis < seat_axes[seat + 1]; axis++){
+            opponents.*strategy_axes[axis] = staged.*strategy_axes[axis];
+        }
+        if(first_difference(opponents, staged) == STRATEGY_AXES_NUM){
+            engine.reuses[seat]++;
+            return engine.best[seat];
+        }
+    }
+    engine.checks[seat]++;
+
+    // only the position's own terms are staged and the sanity checks of staged_value are left to the profile itself.
+    // The deviations are summed in a batch over the position's innermost axes: the scenarios that only reach axes of
+    // the other positions that did not change keep their terms, the others are staged once per range of the block axis
+    // they reach, and the values of the whole block are summed together. They are then searched in cursor order, the
+    // first one that exceeds is returned
+    double best = -numeric_limits<double>::infinity();
+    strategy_cursor deviation;
+    deviation.profile = profile;
+    engine.complete[seat] = false;
+    staged = profile;
+    if(engine.payoffs){
+        cursor_seek(space, deviation, 0, seat_axes[seat], seat_axes[seat + 1]);
+        do {
+            const double value = payoff_seat_value(engine.payoffs->coefficients[pack_profile(engine.payoffs->packer, deviation.profile)],
+                                                   engine.blinds, seat);
+            engine.evaluations[seat]++;
+            if(exceeds(value)){
+                engine.short_circuits[seat]++;
+                return value;
+            }
+            best = max(best, value);
+        } while(cursor_next(space, deviation, seat_axes[seat], seat_axes[seat + 1]) >= 0);
+    } else{
+        staged_batch & batch = engine.batches[seat];
+        if(batch.space != &space){
+            batch = make_staged_batch(engine.evaluator, space,
+                                      batch_first_axis(space, seat_axes[seat], seat_axes[seat + 1], BATCH_MAX_PROFILES),
+                                      seat_axes[seat + 1], seat, seat + 1);
+        }
+        // the outer axes of the position, when all of them make more than one batch
+        cursor_seek(space, deviation, 0, seat_axes[seat], batch.first_axis);
+        do {
+            stage_batch(batch, deviation.profile);
+            if(batch.changed != STRATEGY_AXES_NUM){
+                engine.evaluations[seat] += batch.size;
+            }
+            const vector<double> & values = batch.values[seat];
+            for(uint64_t i = 0; i < batch.size; i++){
+                if(exceeds(values[i])){
+                    engine.short_circuits[seat]++;
+                    return values[i];
+                }
+                best = max(best, values[i]);
+            }
+        } while(cursor_next(space, deviation, seat_axes[seat], batch.first_axis) >= 0);
+    }
+
+    engine.complete[seat] = true;
+    engine.best[seat] = best;
+    return best;
+}
+
+double calc_nash_epsilon(deviation_engine & engine, double bound,
+        const strategy_space & space, const strategy_profile & profile, const positions_values & e){
+
+    double epsilon = 0;
+    for(int seat = 0; seat < POSITIONS_NUM; seat++){
+        auto relative_gain = [&](double t){
+            return e[seat] != 0 ? (t - e[seat]) / abs(e[seat]) : numeric_limits<double>::infinity();
+        };
+        const double t = best_deviation_value(engine, space, profile, seat,
+                                              [&](double value){ return value > e[seat] && relative_gain(value) > bound; });
+        if (t > e[seat]) {
+            epsilon = max(epsilon, relative_gain(t));
+            if (epsilon > bound) {
+                return epsilon;
+            }
+        }
+    }
+    return epsilon;
+}
+
+bool is_nash_point(deviation_engine & engine, double margin,
+        const strategy_space & space, const strategy_profile & profile, const positions_values & e){
+
+    for(int seat = 0; seat < POSITIONS_NUM; seat++){
+        auto exceeds = [&](double t){ return t > e[seat] + margin * abs(e[seat]); };
+        if (exceeds(best_deviation_value(engine, space, profile, seat, exceeds))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+map_strategy_values calc_nash_definition(const ranges_equity_table & ranges_equity, const scenario_probability_table & scenario_probability,
+        double AllIn, double SmallBlind, double BigBlind, double delta, unsigned threads,
+        positions_ranges & co_range, positions_ranges & de_range, positions_ranges & de_co_range,
+        positions_ranges & sb_range, positions_ranges & sb_co_range, positions_ranges & sb_de_range, positions_ranges & sb_co_de_range,
+        positions_ranges & bb_co_range, positions_ranges & bb_de_range, positions_ranges & bb_sb_range,
+        positions_ranges & bb_co_de_range, positions_ranges & bb_co_sb_range, positions_ranges & bb_de_sb_range, positions_ranges & bb_co_de_sb_range,
+        const payoff_table * payoffs, result_sink * sink, const sweep_checkpoint * checkpoint){
+
+
+    map_strategy_values nash_points_values = map_strategy_values();
+    const strategy_space space = make_strategy_space(co_range, de_range, de_co_range, sb_range, sb_co_range, sb_de_range, sb_co_de_range,
+                                                     bb_co_range, bb_de_range, bb_sb_range, bb_co_de_range, bb_co_sb_range, bb_de_sb_range, bb_co_de_sb_range);
+    const bool saved = checkpoint && (!checkpoint->path.empty() || !checkpoint->merge_files.empty());
+    const uint64_t total_iter = strategy_space_size(space, 0, STRATEGY_AXES_NUM),
+            chunk_size = strategy_chunk_size(space, threads, saved), chunks = total_iter / chunk_size;
+
+    cout << "-I- Starting calculation of nash point by definition..." << endl;
+    if(threads > 1){
+        cout << "-I- Threads: " << threads << ", chunks: " << chunks << " of " << chunk_size << " iterations" << endl;
+    }
+    auto start = chrono::steady_clock::now();
+
+    // one sweep records every profile that could still be within one delta of the smallest regret seen so far,
+    // the margin loop below then only re-checks those instead of sweeping again; every worker keeps at most its share of
+    // nash_candidates_max of them, the least regret ones, and the least epsilon it left out
+    const size_t worker_candidates_max = max<uint64_t>(nash_candidates_max / threads, 1);
+    vector<vector<nash_candidate> > thread_candidates(threads);
+    vector<double> thread_dropped(threads, numeric_limits<double>::infinity());
+    vector<deviation_engine> engines(threads, make_deviation_engine(AllIn, BigBlind, SmallBlind, ranges_equity, scenario_probability));
+    const blind_config blinds{AllIn, SmallBlind, BigBlind};
+    for(deviation_engine & engine : engines){
+        engine.payoffs = payoffs;
+    }
+    atomic<double> min_epsilon(numeric_limits<double>::infinity());
+    progress_meter progress;
+    auto candidate_bound = [&](double epsilon){ return epsilon + delta + 2 * MARGIN_TOLERANCE; };
+    // the values of a chunk are staged in batches over its innermost big blind axes
+    const int batch_axis = batch_first_axis(space, seat_axes[3], STRATEGY_AXES_NUM, min<uint64_t>(chunk_size, BATCH_MAX_PROFILES));
+    auto profile_values = [&](staged_batch & batch, const strategy_profile & profile, uint64_t i){
+        if(payoffs){
+            return payoff_value(payoffs->coefficients[pack_profile(payoffs->packer, profile)], blinds);
+        }
+        if(i % batch.size == 0){
+            stage_batch(batch, profile);
+        }
+        return batch_value(batch, i % batch.size);
+    };
+
+    // the smallest regret of the swept chunks is the smallest epsilon of their candidates, so that is all a checkpoint keeps
+    sweep_saver saver;
+    sweep_state resumed;
+    const vector<uint64_t> pending = start_sweep_saver(saver, checkpoint,
+            make_sweep_header(nash_sweep_kind, space, 1, saved ? tables_fingerprint(ranges_equity, scenario_probability) : 0,
+                              chunks, payoffs, delta), space, vector<blind_config>{blinds}, threads, resumed);
+    thread_dropped[0] = resumed.dropped_epsilon;
+    for(const nash_candidate & candidate : resumed.candidates){
+        min_epsilon = min(min_epsilon.load(), candidate.epsilon);
+        add_nash_candidate(thread_candidates[0], worker_candidates_max, candidate, thread_dropped[0]);
+    }
+    vector<nash_candidate>().swap(resumed.candidates);
+    auto add_worker = [&](unsigned worker, sweep_state & state){
+        state.candidates.insert(state.candidates.end(), thread_candidates[worker].begin(), thread_candidates[worker].end());
+        state.dropped_epsilon = min(state.dropped_epsilon, thread_dropped[worker]);
+    };
+    start_progress(progress, "nash sweep", "profiles", pending.size() * chunk_size);
+
+    run_chunks(pending.size(), threads, [&](unsigned worker, uint64_t index){
+        const uint64_t chunk = pending[index];
+        unique_lock<mutex> guard(saver.worker_locks[worker]);
+        vector<nash_candidate> & candidates = thread_candidates[worker];
+        staged_batch batch = make_staged_batch(make_staged_evaluator(AllIn, BigBlind, SmallBlind, ranges_equity, scenario_probability),
+                                               space, batch_axis, STRATEGY_AXES_NUM, 0, POSITIONS_NUM);
+        strategy_cursor cursor;
+        cursor_seek(space, cursor, chunk * chunk_size, 0, STRATEGY_AXES_NUM);
+        uint64_t evaluations = 0;
+        for(uint64_t i = 0; i < chunk_size; i++, cursor_next(space, cursor, 0, STRATEGY_AXES_NUM)){
+            const positions_values e = profile_values(batch, cursor.profile, i);
+            evaluations++;
+
+            const double bound = candidate_bound(min_epsilon);
+            const double epsilon = calc_nash_epsilon(engines[worker], bound, space, cursor.profile, e);
+            if (epsilon > bound) {
+                continue;
+            }
+            add_nash_candidate(candidates, worker_candidates_max, nash_candidate{strategy_position(space, cursor), e, epsilon},
+                               thread_dropped[worker]);
+            double seen = min_epsilon;
+            while(epsilon < seen && !min_epsilon.compare_exchange_weak(seen, epsilon));
+        }
+
+        // out of the bound now, not left out: the margin pass would not look at them anyway
+        const double bound = candidate_bound(min_epsilon);
+        while(!candidates.empty() && candidates.front().epsilon > bound){
+            pop_heap(candidates.begin(), candidates.end(), least_regret_first);
+            candidates.pop_back();
+        }
+        saver.worker_chunks[worker].push_back(chunk);
+        guard.unlock();
+        stats.sweep_profiles += chunk_size;
+        stats.profile_evaluations += evaluations;
+        add_deviation_stats(engines[worker]);
+        report_progress(progress, chunk_size);
+        save_checkpoint(saver, false, add_worker);
+    });
+    finish_progress(progress);
+    save_checkpoint(saver, true, add_worker);
+    record_phase("sweep", start);
+    if(checkpoint && checkpoint->shards > 1){
+        cout << "-I- Shard done, merge " << saver.path << " with the other shards for the results" << endl;
+        return nash_points_values;
+    }
+    start = chrono::steady_clock::now();
+
+    if(std::isinf(min_epsilon)){
+        cout << "-E- no profile can reach a nash point at any margin" << endl;
+        record_phase("result_extraction", start);
+        return nash_points_values;
+    }
+    cout << "-I- Minimal margin: " << min_epsilon << endl;
+
+    // same margins as growing by delta would visit, each candidate is confirmed by the definition itself
+    double margin = delta;
+    while(margin < min_epsilon - MARGIN_TOLERANCE){
+        margin += delta;
+    }
+    // in sweep order, so the csv is the same whatever the threads and whether the sweep was resumed; every worker's
+    // candidates are released once moved over
+    vector<nash_candidate> candidates;
+    double dropped_epsilon = numeric_limits<double>::infinity();
+    for(unsigned worker = 0; worker < threads; worker++){
+        candidates.insert(candidates.end(), thread_candidates[worker].begin(), thread_candidates[worker].end());
+        vector<nash_candidate>().swap(thread_candidates[worker]);
+        dropped_epsilon = min(dropped_epsilon, thread_dropped[worker]);
+    }
+    sort(candidates.begin(), candidates.end(),
+         [](const nash_candidate & candidate, const nash_candidate & other){ return candidate.profile < other.profile; });
+
+    // the points go to the sink's csv as they are confirmed and only its --top ones stay in memory, without a sink all of
+    // them are returned
+    uint64_t points = 0;
+    auto add_point = [&](const nash_candidate & point){
+        points++;
+        if(sink){
+            add_nash_point(*sink, space, point, AllIn, SmallBlind, BigBlind);
+        } else{
+            nash_points_values[strategy_of(unpack_profile(space, point.profile))] =
+                    positions_expectancy(point.values.begin(), point.values.end());
+        }
+    };
+    // the margin takes a candidate that was left out: the whole space is swept again, in windows of chunks small enough
+    // for their points to fit in the memory of the candidates, each window passed on in sweep order once swept
+    const uint64_t window = NASH_RESCAN_WINDOW * (uint64_t)threads;
+    const int rescan_axis = batch_first_axis(space, 0, STRATEGY_AXES_NUM, max<uint64_t>(nash_candidates_max / window, 1));
+    const uint64_t rescan_chunk_size = strategy_space_size(space, rescan_axis, STRATEGY_AXES_NUM);
+    const int rescan_batch_axis = batch_first_axis(space, seat_axes[3], STRATEGY_AXES_NUM,
+                                                   min<uint64_t>(rescan_chunk_size, BATCH_MAX_PROFILES));
+    auto rescan = [&]{
+        vector<vector<nash_candidate> > window_points(window);
+        for(uint64_t first = 0; first < total_iter; first += window * rescan_chunk_size){
+            const uint64_t window_chunks = min(window, (total_iter - first) / rescan_chunk_size);
+            run_chunks(window_chunks, threads, [&](unsigned worker, uint64_t index){
+                staged_batch batch = make_staged_batch(make_staged_evaluator(AllIn, BigBlind, SmallBlind, ranges_equity, scenario_probability),
+                                                       space, rescan_batch_axis, STRATEGY_AXES_NUM, 0, POSITIONS_NUM);
+                strategy_cursor cursor;
+                cursor_seek(space, cursor, first + index * rescan_chunk_size, 0, STRATEGY_AXES_NUM);
+                uint64_t evaluations = 0;
+                for(uint64_t i = 0; i < rescan_chunk_size; i++, cursor_next(space, cursor, 0, STRATEGY_AXES_NUM)){
+                    const positions_values e = profile_values(batch, cursor.profile, i);
+                    evaluations++;
+                    const double epsilon = calc_nash_epsilon(engines[worker], margin + MARGIN_TOLERANCE, space, cursor.profile, e);
+                    if(epsilon <= margin + MARGIN_TOLERANCE && is_nash_point(engines[worker], margin, space, cursor.profile, e)){
+                        window_points[index].push_back(nash_candidate{strategy_position(space, cursor), e, epsilon});
+                    }
+                }
+                stats.profile_evaluations += evaluations;
+                add_deviation_stats(engines[worker]);
+            });
+            for(uint64_t index = 0; index < window_chunks; index++){
+                for(const nash_candidate & point : window_points[index]){
+                    add_point(point);
+                }
+                window_points[index].clear();
+            }
+        }
+    };
+    while(points == 0) {
+        cout << "-I- Current margin: " << margin << endl;
+        stats.margin_iterations++;
+        if(dropped_epsilon <= margin + MARGIN_TOLERANCE){
+            cout << "-I- Sweeping again for the candidates left out, --max-candidates is " << nash_candidates_max << endl;
+            rescan();
+        } else{
+            for(auto const & candidate : candidates){
+                if(candidate.epsilon <= margin + MARGIN_TOLERANCE &&
+                   is_nash_point(engines[0], margin, space, unpack_profile(space, candidate.profile), candidate.values)){
+                    add_point(candidate);
+                }
+            }
+        }
+        margin += delta;
+    }
+    if(sink){
+        nash_points_values = sink_nash_points(*sink, space);
+        sink->kept.clear();
+        cout << "-I- Nash points: " << points;
+        if(!sink->path.empty()){
+            cout << ", written to " << sink->path;
+        }
+        if(!sink->top){
+            cout << ", none kept without --top";
+        } else if(points > sink->top){
+            cout << ", the " << sink->top << " least regret ones kept";
+        }
+        cout << endl;
+    }
+
+    print_nash_points(nash_points_values);
+
+    // the margin loop confirms the candidates with the first engine, the sweep added every chunk's counters already
+    add_deviation_stats(engines[0]);
+    record_phase("result_extraction", start);
+    return nash_points_values;
+}
+
+void print_nash_points(const map_strategy_values & nash_points_values){
+    cout << "-I- Results:" << endl;
+    for(auto x: nash_points_values){
+        cout << "CO: "<< x.first[0] << endl << x.second[0] << endl
+        << "DE: " << x.first[1] << ", " << x.first[2] << endl << x.second[1] << endl
+        << "SB: " << x.first[3] << ", " << x.first[4] << ", " << x.first[5] << ", " << x.first[6] << endl << x.second[2] << endl
+        << "BB: " << x.first[7] << ", " << x.first[8] << ", " << x.first[9] << ", " << x.first[10] << ", "
+            << x.first[11] << ", " << x.first[12] << ", " << x.first[13] << endl << x.second[3] << endl;
+    }
+}
+
+void open_result_sink(result_sink & sink, const string & path, size_t top){
+    sink.path = path;
+    sink.top = top;
+    if(path.empty()){
+        return;
+    }
+    sink.file.open(path, ios::trunc);
+    if(!sink.file.is_open()){
+        cout << "-E- failed to open " << path << " for writing" << endl;
+        throw exception();
+    }
+    sink.file.precision(numeric_limits<double>::max_digits10);
+    sink.file << "all_in,small_blind,big_blind";
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        sink.file << "," << strategy_axis_names[axis];
+    }
+    sink.file << ",co_value,de_value,sb_value,bb_value,epsilon" << endl;
+}
+
+void add_nash_point(result_sink & sink, const strategy_space & space, const nash_candidate & point,
+        double AllIn, double SmallBlind, double BigBlind){
+    sink.points++;
+    if(sink.file.is_open()){
+        const strategy_profile profile = unpack_profile(space, point.profile);
+        sink.file << AllIn << "," << SmallBlind << "," << BigBlind;
+        for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+            sink.file << "," << profile.*strategy_axes[axis];
+        }
+        for(int seat = 0; seat < POSITIONS_NUM; seat++){
+            sink.file << "," << point.values[seat];
+        }
+        sink.file << "," << point.epsilon << "\n";
+        if(!sink.file){
+            cout << "-E- failed to write " << sink.path << endl;
+            throw exception();
+        }
+    }
+
+    // without --top the csv is the only copy
+    if(!sink.top){
+        return;
+    }
+    if(sink.kept.size() < sink.top){
+        sink.kept.push_back(point);
+        push_heap(sink.kept.begin(), sink.kept.end(), least_regret_first);
+    } else if(least_regret_first(point, sink.kept.front())){
+        pop_heap(sink.kept.begin(), sink.kept.end(), least_regret_first);
+        sink.kept.back() = point;
+        push_heap(sink.kept.begin(), sink.kept.end(), least_regret_first);
+    }
+}
+
+void add_nash_candidate(vector<nash_candidate> & candidates, size_t limit, const nash_candidate & candidate, double & dropped_epsilon){
+    if(candidates.size() < limit){
+        candidates.push_back(candidate);
+        push_heap(candidates.begin(), candidates.end(), least_regret_first);
+    } else if(least_regret_first(candidate, candidates.front())){
+        dropped_epsilon = min(dropped_epsilon, candidates.front().epsilon);
+        pop_heap(candidates.begin(), candidates.end(), least_regret_first);
+        candidates.back() = candidate;
+        push_heap(candidates.begin(), candidates.end(), least_regret_first);
+    } else{
+        dropped_epsilon = min(dropped_epsilon, candidate.epsilon);
+    }
+}
+
+bool least_regret_first(const nash_candidate & candidate, const nash_candidate & other){
+    if(candidate.epsilon != other.epsilon){
+        return candidate.epsilon < other.epsilon;
+    }
+    return candidate.profile < other.profile;
+}
+
+map_strategy_values sink_nash_points(const result_sink & sink, const strategy_space & space){
+    map_strategy_values nash_points_values = map_strategy_values();
+    for(const nash_candidate & point : sink.kept){
+        nash_points_values[strategy_of(unpack_profile(space, point.profile))] = positions_expectancy(point.values.begin(), point.values.end());
+    }
+    return nash_points_values;
+}
+
+sweep_file_header make_sweep_header(sweep_kind kind, const strategy_space & space, size_t configs_num, uint64_t tables_hash,
+        uint64_t chunks, bool payoffs, double delta){
+    sweep_file_header header = sweep_file_header();
+    memcpy(header.magic, SWEEP_FILE_MAGIC, sizeof(header.magic));
+    header.version = SWEEP_FILE_VERSION;
+    header.byte_order = TABLE_FILE_BYTE_ORDER;
+    header.kind = kind;
+    header.payoffs = payoffs;
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        header.axis_sizes[axis] = space.axes[axis].size();
+    }
+    header.configs_num = configs_num;
+    header.tables_hash = tables_hash;
+    header.chunks = chunks;
+    header.delta = delta;
+    return header;
+}
+
+void write_sweep_file(const string & path, const sweep_file_header & header, const strategy_space & space,
+        const vector<blind_config> & configs, const sweep_state & state){
+    static_assert(sizeof(nash_candidate) == sizeof(packed_profile) + (POSITIONS_NUM + 1) * sizeof(double), "nash_candidate must be packed");
+    // written next to the file and renamed over it, a run killed while saving leaves the previous checkpoint
+    const string temporary = path + ".tmp";
+    ofstream myfile(temporary, ios::binary | ios::trunc);
+    if(!myfile.is_open()){
+        cout << "-E- failed to open " << temporary << " for writing" << endl;
+        throw exception();
+    }
+
+    sweep_file_header file_header = header;
+    file_header.candidates_num = state.candidates.size();
+    file_header.dropped_epsilon = state.dropped_epsilon;
+    myfile.write(reinterpret_cast<const char *>(&file_header), sizeof(file_header));
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        for(auto range : space.axes[axis]){
+            int32_t value = range;
+            myfile.write(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+    }
+    for(const blind_config & config : configs){
+        const double blinds[BLIND_TERMS_NUM] = {config.all_in, config.small_blind, config.big_blind};
+        myfile.write(reinterpret_cast<const char *>(blinds), sizeof(blinds));
+    }
+    myfile.write(state.swept.data(), state.swept.size());
+    for(const auto & min_values : state.min_values){
+        for(int seat = 0; seat < POSITIONS_NUM; seat++){
+            myfile.write(reinterpret_cast<const char *>(min_values[seat].data()), min_values[seat].size() * sizeof(double));
+        }
+    }
+    myfile.write(reinterpret_cast<const char *>(state.candidates.data()), state.candidates.size() * sizeof(nash_candidate));
+    myfile.close();
+    if(!myfile || rename(temporary.c_str(), path.c_str()) != 0){
+        cout << "-E- failed to write " << path << endl;
+        throw exception();
+    }
+}
+
+bool read_sweep_file(const string & path, const sweep_file_header & expected, const strategy_space & space,
+        const vector<blind_config> & configs, sweep_state & state){
+    ifstream myfile(path, ios::binary);
+    if(!myfile.is_open()){
+        return false;
+    }
+
+    // resuming another run would silently mix two sweeps, so anything but the same sweep is an error
+    auto mismatch = [&](const string & what){
+        cout << "-E- " << path << " is a checkpoint of " << what << ", not of this run" << endl;
+        throw exception();
+    };
+    sweep_file_header header;
+    if(!myfile.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+       memcmp(header.magic, SWEEP_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+       header.version != SWEEP_FILE_VERSION || header.byte_order != TABLE_FILE_BYTE_ORDER){
+        cout << "-E- " << path << " is not a checkpoint file of this version" << endl;
+        throw exception();
+    }
+    if(header.kind != expected.kind){
+        mismatch(header.kind == nash_sweep_kind ? "a Nash sweep" : "a MinMax sweep");
+    }
+    if(header.tables_hash != expected.tables_hash){
+        mismatch("other data files");
+    }
+    if(header.payoffs != expected.payoffs){
+        mismatch(header.payoffs ? "a run with --payoff-cache" : "a run without --payoff-cache");
+    }
+    if(header.configs_num != expected.configs_num || header.delta != expected.delta){
+        mismatch("other blinds");
+    }
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        if(header.axis_sizes[axis] != expected.axis_sizes[axis]){
+            mismatch(string("other ") + strategy_axis_names[axis] + " ranges");
+        }
+    }
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        for(auto range : space.axes[axis]){
+            int32_t value;
+            myfile.read(reinterpret_cast<char *>(&value), sizeof(value));
+            if(myfile && value != range){
+                mismatch(string("other ") + strategy_axis_names[axis] + " ranges");
+            }
+        }
+    }
+    for(const blind_config & config : configs){
+        double blinds[BLIND_TERMS_NUM];
+        myfile.read(reinterpret_cast<char *>(blinds), sizeof(blinds));
+        if(myfile && (blinds[0] != config.all_in || blinds[1] != config.small_blind || blinds[2] != config.big_blind)){
+            mismatch("other blinds");
+        }
+    }
+    if(header.chunks != expected.chunks){
+        mismatch("another chunking");
+    }
+
+    state.swept.resize(header.chunks);
+    myfile.read(state.swept.data(), state.swept.size());
+    if(header.kind == min_max_sweep_kind){
+        state.min_values.resize(header.configs_num);
+        for(auto & min_values : state.min_values){
+            for(int seat = 0; seat < POSITIONS_NUM; seat++){
+                min_values[seat].resize(strategy_space_size(space, seat_axes[seat], seat_axes[seat + 1]));
+                myfile.read(reinterpret_cast<char *>(min_values[seat].data()), min_values[seat].size() * sizeof(double));
+            }
+        }
+    }
+    // candidates_num is the one size taken from the file alone, it has to fit in the rest of the file before it is allocated
+    auto invalid = [&]{
+        cout << "-E- invalid checkpoint file " << path << endl;
+        throw exception();
+    };
+    const streampos candidates_start = myfile.tellg();
+    if(!myfile || !myfile.seekg(0, ios::end)){
+        invalid();
+    }
+    const uint64_t left = myfile.tellg() - candidates_start;
+    if(!myfile.seekg(candidates_start) || header.candidates_num > left / sizeof(nash_candidate)){
+        invalid();
+    }
+    state.candidates.resize(header.candidates_num);
+    state.dropped_epsilon = header.dropped_epsilon;
+    myfile.read(reinterpret_cast<char *>(state.candidates.data()), state.candidates.size() * sizeof(nash_candidate));
+    if(!myfile || myfile.peek() != EOF){
+        invalid();
+    }
+    return true;
+}
+
+vector<uint64_t> start_sweep_saver(sweep_saver & saver, const sweep_checkpoint * checkpoint, const sweep_file_header & header,
+        const strategy_space & space, const vector<blind_config> & configs, unsigned threads, sweep_state & resumed){
+    saver.path = checkpoint ? checkpoint->path : "";
+    saver.interval = checkpoint ? checkpoint->interval : CHECKPOINT_INTERVAL_S;
+    saver.header = header;
+    saver.space = space;
+    saver.configs = configs;
+    saver.worker_locks = vector<mutex>(threads);
+    saver.worker_chunks.assign(threads, vector<uint64_t>());
+    saver.saved = chrono::steady_clock::now();
+
+    const bool merging = checkpoint && !checkpoint->merge_files.empty();
+    if(merging){
+        for(const string & path : checkpoint->merge_files){
+            sweep_state state;
+            if(!read_sweep_file(path, header, space, configs, state)){
+                cout << "-E- failed to open " << path << endl;
+                throw exception();
+            }
+            add_sweep_state(resumed, state, path);
+        }
+    } else if(!saver.path.empty() && checkpoint->resume && !read_sweep_file(saver.path, header, space, configs, resumed)){
+        cout << "-I- No checkpoint at " << saver.path << " yet, starting from the beginning" << endl;
+    }
+    for(uint64_t chunk = 0; chunk < resumed.swept.size(); chunk++){
+        if(resumed.swept[chunk]){
+            saver.worker_chunks[0].push_back(chunk);
+        }
+    }
+    if(merging){
+        cout << "-I- Merging " << checkpoint->merge_files.size() << " sweep files: " << saver.worker_chunks[0].size() << " of "
+             << header.chunks << " chunks swept" << endl;
+        if(saver.worker_chunks[0].size() < header.chunks){
+            cout << "-E- " << header.chunks - saver.worker_chunks[0].size() << " chunks are in none of the files, "
+                 << "merge needs the files of every shard" << endl;
+            throw exception();
+        }
+    } else if(!resumed.swept.empty()){
+        cout << "-I- Resuming from " << saver.path << ": " << saver.worker_chunks[0].size() << " of " << header.chunks
+             << " chunks already swept" << endl;
+    }
+
+    // the shards split the chunks the same way in every process, whatever its threads
+    const unsigned shard = checkpoint ? checkpoint->shard : 0, shards = checkpoint ? checkpoint->shards : 1;
+    const uint64_t first = header.chunks * shard / shards, last = header.chunks * (shard + 1) / shards;
+    if(shards > 1){
+        cout << "-I- Shard " << shard << "/" << shards << ": chunks " << first << " to " << last << " of " << header.chunks << endl;
+    }
+    vector<uint64_t> pending;
+    for(uint64_t chunk = first; chunk < last; chunk++){
+        if(resumed.swept.empty() || !resumed.swept[chunk]){
+            pending.push_back(chunk);
+        }
+    }
+    return pending;
+}
+
+void save_checkpoint(sweep_saver & saver, bool force, const function<void(unsigned, sweep_state &)> & add_worker){
+    if(saver.path.empty()){
+        return;
+    }
+    unique_lock<mutex> saving(saver.saving, defer_lock);
+    if(force){
+        saving.lock();
+    } else if(!saving.try_lock() || chrono::steady_clock::now() - saver.saved < chrono::seconds(saver.interval)){
+        return;
+    }
+
+    // every worker is taken between two chunks, so its part of the state covers exactly the chunks it lists; a chunk
+    // swept after its worker was taken is simply swept again on resume
+    sweep_state state;
+    state.swept.assign(saver.header.chunks, 0);
+    uint64_t swept = 0;
+    for(unsigned worker = 0; worker < saver.worker_locks.size(); worker++){
+        lock_guard<mutex> guard(saver.worker_locks[worker]);
+        for(uint64_t chunk : saver.worker_chunks[worker]){
+            state.swept[chunk] = 1;
+        }
+        swept += saver.worker_chunks[worker].size();
+        add_worker(worker, state);
+    }
+    write_sweep_file(saver.path, saver.header, saver.space, saver.configs, state);
+    saver.saved = chrono::steady_clock::now();
+    cout << "-I- Checkpoint: " << swept << " of " << saver.header.chunks << " chunks swept, saved to " << saver.path << endl;
+}
+
+void add_sweep_state(sweep_state & state, const sweep_state & other, const string & path){
+    if(state.swept.empty()){
+        state = other;
+        return;
+    }
+    // a chunk in two files would count its candidates twice
+    for(uint64_t chunk = 0; chunk < state.swept.size(); chunk++){
+        if(state.swept[chunk] && other.swept[chunk]){
+            cout << "-E- " << path << " has chunk " << chunk << " of another file too, merge needs the files of different shards" << endl;
+            throw exception();
+        }
+        state.swept[chunk] |= other.swept[chunk];
+    }
+    for(size_t config = 0; config < state.min_values.size(); config++){
+        for(int seat = 0; seat < POSITIONS_NUM; seat++){
+            vector<double> & min_values = state.min_values[config][seat];
+            for(size_t i = 0; i < min_values.size(); i++){
+                min_values[i] = min(min_values[i], other.min_values[config][seat][i]);
+            }
+        }
+    }
+    state.candidates.insert(state.candidates.end(), other.candidates.begin(), other.candidates.end());
+    state.dropped_epsilon = min(state.dropped_epsilon, other.dropped_epsilon);
+}
+
+uint64_t strategy_position(const strategy_space & space, const strategy_cursor & cursor){
+    uint64_t position = 0;
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        position = position * space.axes[axis].size() + cursor.index[axis];
+    }
+    return position;
+}
+
+map_strategy_values calc_best_response(const ranges_equity_table & ranges_equity, const scenario_probability_table & scenario_probability,
+        double AllIn, double SmallBlind, double BigBlind, unsigned max_rounds,
+        positions_ranges & co_range, positions_ranges & de_range, positions_ranges & de_co_range,
+        positions_ranges & sb_range, positions_ranges & sb_co_range, positions_ranges & sb_de_range, positions_ranges & sb_co_de_range,
+        positions_ranges & bb_co_range, positions_ranges & bb_de_range, positions_ranges & bb_sb_range,
+        positions_ranges & bb_co_de_range, positions_ranges & bb_co_sb_range, positions_ranges & bb_de_sb_range, positions_ranges & bb_co_de_sb_range){
+
+    const strategy_space space = make_strategy_space(co_range, de_range, de_co_range, sb_range, sb_co_range, sb_de_range, sb_co_de_range,
+                                                     bb_co_range, bb_de_range, bb_sb_range, bb_co_de_range, bb_co_sb_range, bb_de_sb_range, bb_co_de_sb_range);
+
+    // profiles are revisited across rounds and by the final regret check, so every evaluation is cached by position
+    unordered_map<uint64_t, positions_values> evaluations;
+    auto evaluate = [&](const strategy_cursor & cursor) -> positions_values {
+        const uint64_t position = strategy_position(space, cursor);
+        auto itr = evaluations.find(position);
+        if(itr == evaluations.end()){
+            itr = evaluations.emplace(position, calc_iteration_value(AllIn, BigBlind, SmallBlind, cursor.profile,
+                                                                     ranges_equity, scenario_probability)).first;
+        }
+        return itr->second;
+    };
+
+    // the best reply of one position to the others, keeping the current strategy unless another one is strictly better
+    auto best_response = [&](const strategy_cursor & cursor, int seat) -> strategy_cursor {
+        strategy_cursor best = cursor, deviation = cursor;
+        double best_value = evaluate(cursor)[seat];
+        cursor_seek(space, deviation, 0, seat_axes[seat], seat_axes[seat + 1]);
+        do {
+            const double value = evaluate(deviation)[seat];
+            if(value > best_value){
+                best_value = value;
+                best = deviation;
+            }
+        } while(cursor_next(space, deviation, seat_axes[seat], seat_axes[seat + 1]) >= 0);
+        return best;
+    };
+
+    // the largest relative gain any position could get by deviating alone, i.e. the smallest nash margin the profile meets
+    auto regret = [&](const strategy_cursor & cursor) -> double {
+        const positions_values e = evaluate(cursor);
+        double epsilon = 0;
+        for(int seat = 0; seat < POSITIONS_NUM; seat++){
+            const double gain = evaluate(best_response(cursor, seat))[seat] - e[seat];
+            if(gain > 0){
+                epsilon = max(epsilon, e[seat] != 0 ? gain / abs(e[seat]) : numeric_limits<double>::infinity());
+            }
+        }
+        return epsilon;
+    };
+
+    cout << "-I- Starting calculation of nash point by best response..." << endl;
+    auto start = chrono::steady_clock::now();
+
+    strategy_cursor current;
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        current.index[axis] = space.axes[axis].size() / 2;
+        current.profile.*strategy_axes[axis] = space.axes[axis][current.index[axis]];
+    }
+
+    vector<strategy_cursor> history;
+    size_t cycle_start = 0;
+    bool converged = false;
+    for(unsigned round = 0; round < max_rounds && !converged; round++){
+        const uint64_t position = strategy_position(space, current);
+        auto visited = find_if(history.begin(), history.end(), [&](const strategy_cursor & cursor){
+            return strategy_position(space, cursor) == position;
+        });
+        if(visited != history.end()){
+            cycle_start = distance(history.begin(), visited);
+            break;
+        }
+        history.push_back(current);
+
+        converged = true;
+        for(int seat = 0; seat < POSITIONS_NUM; seat++){
+            strategy_cursor best = best_response(current, seat);
+            if(strategy_position(space, best) != strategy_position(space, current)){
+                current = best;
+                converged = false;
+            }
+        }
+        if(progress_output) cout << "=" << flush;
+    }
+    if(progress_output) cout << endl;
+    record_phase("sweep", start);
+    start = chrono::steady_clock::now();
+    if(!converged && history.size() < max_rounds){
+        cout << "-I- Best response cycles over " << history.size() - cycle_start << " profiles" << endl;
+    }
+
+    strategy_cursor result = current;
+    double epsilon = 0;
+    if(converged){
+        cout << "-I- Converged after " << history.size() << " rounds" << endl;
+    } else{
+        // no fixed point reached, report the profile of the cycle (or of the whole run) closest to an equilibrium
+        epsilon = numeric_limits<double>::infinity();
+        for(size_t i = cycle_start; i < history.size(); i++){
+            const double profile_epsilon = regret(history[i]);
+            if(profile_epsilon < epsilon){
+                epsilon = profile_epsilon;
+                result = history[i];
+            }
+        }
+
+        // then walk downhill in regret, one range of one position at a time, from the best of them
+        bool improved = true;
+        for(unsigned step = 0; step < max_rounds && improved && epsilon > 0; step++){
+            improved = false;
+            strategy_cursor origin = result;
+            for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+                strategy_cursor neighbour = origin;
+                for(size_t i = 0; i < space.axes[axis].size(); i++){
+                    if((int)i == origin.index[axis]){
+                        continue;
+                    }
+                    neighbour.index[axis] = i;
+                    neighbour.profile.*strategy_axes[axis] = space.axes[axis][i];
+                    const double neighbour_epsilon = regret(neighbour);
+                    if(neighbour_epsilon < epsilon){
+                        epsilon = neighbour_epsilon;
+                        result = neighbour;
+                        improved = true;
+                    }
+                }
+            }
+            if(progress_output) cout << "=" << flush;
+        }
+        if(progress_output) cout << endl;
+        cout << "-I- Did not converge, least regret profile margin: " << epsilon << endl;
+    }
+    cout << "-I- Evaluated " << evaluations.size() << " of " << strategy_space_size(space, 0, STRATEGY_AXES_NUM) << " profiles" << endl;
+
+    const positions_values e = evaluate(result);
+    map_strategy_values nash_points_values = map_strategy_values();
+    nash_points_values[strategy_of(result.profile)] = positions_expectancy(e.begin(), e.end());
+    print_nash_points(nash_points_values);
+
+    record_phase("result_extraction", start);
+    return nash_points_values;
+}
+
+
+int serve(const run_options & options, ostream & responses){
+    ranges_equity_table ranges_equity = load_ranges_equity_table(table_file_path(options.equity_file));
+    scenario_probability_table scenario_probability = load_scenario_probability_table(table_file_path(options.frequency_file));
+
+    if(options.socket_path.empty()){
+        cout << "-I- serving requests from stdin" << endl;
+        string line;
+        while(getline(cin, line)){
+            responses << serve_request(line, ranges_equity, scenario_probability, options) << endl;
+        }
+        return 0;
+    }
+
+    sockaddr_un address = sockaddr_un();
+    address.sun_family = AF_UNIX;
+    if(options.socket_path.size() >= sizeof(address.sun_path)){
+        cout << "-E- socket path too long: " << options.socket_path << endl;
+        return 1;
+    }
+    strncpy(address.sun_path, options.socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    unique_fd listener(socket(AF_UNIX, SOCK_STREAM, 0));
+    unlink(options.socket_path.c_str());
+    if(listener.fd < 0 || ::bind(listener.fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(listener.fd, 16) != 0){
+        cout << "-E- failed to listen on " << options.socket_path << ": " << strerror(errno) << endl;
+        return 1;
+    }
+    // a client that hangs up before its response must not take the server down
+    signal(SIGPIPE, SIG_IGN);
+    cout << "-I- serving requests on " << options.socket_path << endl;
+
+    // connections are served one at a time, the solvers already use every worker thread
+    while(true){
+        unique_fd connection(accept(listener.fd, nullptr, nullptr));
+        if(connection.fd < 0){
+            if(errno == EINTR) continue;
+            cout << "-E- accept failed: " << strerror(errno) << endl;
+            return 1;
+        }
+
+        string pending;
+        char buffer[4096];
+        bool open = true;
+        while(open){
+            ssize_t received = read(connection.fd, buffer, sizeof(buffer));
+            if(received < 0 && errno == EINTR) continue;
+            if(received <= 0) break;
+            pending.append(buffer, received);
+
+            size_t line_end;
+            while(open && (line_end = pending.find('\n')) != string::npos){
+                string response = serve_request(pending.substr(0, line_end), ranges_equity, scenario_probability, options) + "\n";
+                pending.erase(0, line_end + 1);
+                for(size_t sent = 0; sent < response.size(); ){
+                    ssize_t written = write(connection.fd, response.data() + sent, response.size() - sent);
+                    if(written < 0 && errno == EINTR) continue;
+                    if(written <= 0){
+                        open = false;
+                        break;
+                    }
+                    sent += written;
+                }
+            }
+        }
+    }
+}
+
+string serve_request(const string & line, const ranges_equity_table & ranges_equity,
+        const scenario_probability_table & scenario_probability, const run_options & options){
+    solve_request request;
+    request.threads = options.threads;
+    string error;
+
+    ostringstream response;
+    response.precision(numeric_limits<double>::max_digits10);
+
+    text_scanner scanner{line.data(), line.data() + line.size()};
+    bool scanned = scan_solve_request(scanner, request, error);
+    // the work of every solver grows with the profiles of the space, a request of 14 long axes could overflow their count
+    uint64_t profiles;
+    if(scanned && (!checked_space_size(request.space, profiles) || profiles > options.max_profiles)){
+        error = "too many profiles, the limit is " + to_string(options.max_profiles);
+        scanned = false;
+    }
+    if(scanned){
+        strategy_space & space = request.space;
+        try{
+            // ranges between the data buckets get tables of their own, the shared ones stay as they are
+            ranges_equity_table request_equity = ranges_equity;
+            scenario_probability_table request_probability = scenario_probability;
+            refine_range_grid(request_equity, request_probability, space);
+            if(request.algorithm == "minmax"){
+                vector<position_strategy> strategies = calc_min_max(request_equity, request_probability, request.all_in, request.small_blind, request.big_blind, request.threads,
+                        space.axes[0], space.axes[1], space.axes[2], space.axes[3], space.axes[4], space.axes[5], space.axes[6],
+                        space.axes[7], space.axes[8], space.axes[9], space.axes[10], space.axes[11], space.axes[12], space.axes[13]);
+                response << "\"strategies\":[";
+                for(size_t seat = 0; seat < strategies.size(); seat++){
+                    response << (seat ? "," : "");
+                    write_json_ranges(response, strategies[seat].begin(), strategies[seat].end());
+                }
+                response << "]";
+            } else{
+                double delta = 0.02;
+                unsigned max_rounds = 1000;
+                if(options.prune){
+                    prune_dominated_ranges(request_equity, request_probability, request.all_in, request.small_blind, request.big_blind,
+                            options.prune_epsilon, space.axes[0], space.axes[1], space.axes[2], space.axes[3], space.axes[4], space.axes[5],
+                            space.axes[6], space.axes[7], space.axes[8], space.axes[9], space.axes[10], space.axes[11], space.axes[12],
+                            space.axes[13]);
+                }
+                map_strategy_values points = request.algorithm == "nash" ?
+                        calc_nash_definition(request_equity, request_probability, request.all_in, request.small_blind, request.big_blind, delta, request.threads,
+                                             space.axes[0], space.axes[1], space.axes[2], space.axes[3], space.axes[4], space.axes[5], space.axes[6],
+                                             space.axes[7], space.axes[8], space.axes[9], space.axes[10], space.axes[11], space.axes[12], space.axes[13]) :
+                        calc_best_response(request_equity, request_probability, request.all_in, request.small_blind, request.big_blind, max_rounds,
+                                           space.axes[0], space.axes[1], space.axes[2], space.axes[3], space.axes[4], space.axes[5], space.axes[6],
+                                           space.axes[7], space.axes[8], space.axes[9], space.axes[10], space.axes[11], space.axes[12], space.axes[13]);
+                response << "\"points\":[";
+                for(auto itr = points.begin(); itr != points.end(); itr++){
+                    response << (itr == points.begin() ? "" : ",") << "{\"strategy\":";
+                    write_json_ranges(response, itr->first.begin(), itr->first.end());
+                    response << ",\"values\":[" << itr->second[0] << "," << itr->second[1] << "," << itr->second[2] << ","
+                             << itr->second[3] << "]}";
+                }
+                response << "]";
+            }
+        } catch(const exception &){
+            error = "solver failed, see the server log";
+        }
+    }
+
+    string body = response.str();
+    response.str("");
+    response << "{";
+    if(!request.id.empty()){
+        response << "\"id\":" << request.id << ",";
+    }
+    if(error.empty()){
+        response << "\"ok\":true,\"algorithm\":\"" << request.algorithm << "\"," << body << "}";
+    } else{
+        cout << "-E- request failed: " << error << endl;
+        response << "\"ok\":false,\"error\":";
+        write_json_string(response, error);
+        response << "}";
+    }
+    return response.str();
+}
+
+bool scan_json_string(text_scanner & scanner, string & value){
+    if(!scan_char(scanner, '"')){
+        return false;
+    }
+    value.clear();
+    while(scanner.pos < scanner.end && *scanner.pos != '"'){
+        char c = *scanner.pos++;
+        if(c == '\\'){
+            if(scanner.pos == scanner.end){
+                return false;
+            }
+            c = *scanner.pos++;
+            // \u escapes are not needed by any key or value of a request
+            if(c == 'n') c = '\n';
+            else if(c == 't') c = '\t';
+            else if(c != '"' && c != '\\' && c != '/') return false;
+        }
+        value += c;
+    }
+    return scan_char(scanner, '"');
+}
+
+bool scan_solve_request(text_scanner & scanner, solve_request & request, string & error){
+    positions_ranges ranges[STRATEGY_AXES_NUM];
+    double threads = request.threads;
+
+    error = "malformed request";
+    if(!scan_char(scanner, '{')){
+        return false;
+    }
+    bool first = true;
+    while(!scan_char(scanner, '}')){
+        string key;
+        if((!first && !scan_char(scanner, ',')) || !scan_json_string(scanner, key) || !scan_char(scanner, ':')){
+            return false;
+        }
+        first = false;
+
+        if(key == "id"){
+            scan_spaces(scanner);
+            const char * start = scanner.pos;
+            string text;
+            double number;
+            if(!scan_json_string(scanner, text)){
+                scanner.pos = start;
+                if(!scan_double(scanner, number)){
+                    return false;
+                }
+            }
+            request.id.assign(start, scanner.pos);
+        } else if(key == "position" || key == "algorithm"){
+            if(!scan_json_string(scanner, key == "position" ? request.position : request.algorithm)){
+                return false;
+            }
+        } else if(key == "all_in" || key == "small_blind" || key == "big_blind" || key == "threads"){
+            double & value = key == "all_in" ? request.all_in : key == "small_blind" ? request.small_blind :
+                             key == "big_blind" ? request.big_blind : threads;
+            if(!scan_double(scanner, value)){
+                return false;
+            }
+        } else if(key == "ranges"){
+            if(!scan_char(scanner, '{')){
+                return false;
+            }
+            bool first_axis = true;
+            while(!scan_char(scanner, '}')){
+                string name;
+                if((!first_axis && !scan_char(scanner, ',')) || !scan_json_string(scanner, name) || !scan_char(scanner, ':') ||
+                   !scan_char(scanner, '[')){
+                    return false;
+                }
+                first_axis = false;
+                const char * const * axis_name = find(strategy_axis_names, strategy_axis_names + STRATEGY_AXES_NUM, name);
+                if(axis_name == strategy_axis_names + STRATEGY_AXES_NUM){
+                    error = "unknown range: " + name;
+                    return false;
+                }
+                positions_ranges & axis = ranges[axis_name - strategy_axis_names];
+                axis.clear();
+                while(!scan_char(scanner, ']')){
+                    int range;
+                    if((!axis.empty() && !scan_char(scanner, ',')) || !scan_int(scanner, range)){
+                        return false;
+                    }
+                    if(range < 0 || range > MAX_RANGE){
+                        error = "range out of bounds in " + name;
+                        return false;
+                    }
+                    axis.push_back(range);
+                }
+                if(axis.empty()){
+                    error = "empty range: " + name;
+                    return false;
+                }
+            }
+        } else{
+            error = "unknown key: " + key;
+            return false;
+        }
+    }
+    if(!scan_line_end(scanner)){
+        return false;
+    }
+
+    const string & pos = request.position, & algo = request.algorithm;
+    if(!pos.empty() && !(pos == "de" || pos == "DE" || pos == "Dealer" || pos == "dealer" ||
+       pos == "sb" || pos == "SB" || pos == "SmallBlind" || pos == "smallblind" || pos == "Smallblind" ||
+       pos == "co" || pos == "CO" || pos == "CutOff" || pos == "cutoff" || pos == "Cutoff")){
+        error = "invalid position: " + pos;
+        return false;
+    }
+    if(algo == "Nash" || algo == "NASH" || algo == "nash"){
+        request.algorithm = "nash";
+    } else if(algo == "BR" || algo == "br" || algo == "BestResponse"){
+        request.algorithm = "br";
+    } else if(algo == "MinMax" || algo == "MINMAX" || algo == "minmax"){
+        request.algorithm = "minmax";
+    } else{
+        error = "invalid algorithm: " + algo;
+        return false;
+    }
+    // compared as doubles first, casting a negative, NaN or too large value is undefined
+    const unsigned cores = max(1u, thread::hardware_concurrency());
+    if(!(threads >= 0) || threads != floor(threads)){
+        error = "invalid threads";
+        return false;
+    }
+    request.threads = threads == 0 || threads > cores ? cores : (unsigned)threads;
+    if(!valid_blinds(blind_config{request.all_in, request.small_blind, request.big_blind})){
+        error = "invalid blinds, they must be positive and at most all_in";
+        return false;
+    }
+
+    // ranges that are not given keep the defaults of the position
+    strategy_space & space = request.space;
+    init_ranges(pos, space.axes[0], space.axes[1], space.axes[2], space.axes[3], space.axes[4], space.axes[5], space.axes[6],
+                space.axes[7], space.axes[8], space.axes[9], space.axes[10], space.axes[11], space.axes[12], space.axes[13]);
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        if(!ranges[axis].empty()){
+            space.axes[axis] = ranges[axis];
+        }
+    }
+    error.clear();
+    return true;
+}
+
+void write_json_string(ostream & out, const string & value){
+    out << '"';
+    for(char c : value){
+        if(c == '"' || c == '\\'){
+            out << '\\' << c;
+        } else if(c == '\n'){
+            out << "\\n";
+        } else if((unsigned char)c < 0x20){
+            out << ' ';
+        } else{
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+void write_json_ranges(ostream & out, positions_ranges::const_iterator first, positions_ranges::const_iterator last){
+    out << "[";
+    for(auto itr = first; itr != last; itr++){
+        out << (itr == first ? "" : ",") << *itr;
+    }
+    out << "]";
+}
+
+
+positions_values calc_iteration_value(double AllIn, double Bb, double Sb, const strategy_profile & profile,
+              const ranges_equity_table& ranges_equities, const scenario_probability_table& scenario_probabilities) {
+    stats.profile_evaluations++;
+    staged_evaluator evaluator = make_staged_evaluator(AllIn, Bb, Sb, ranges_equities, scenario_probabilities);
+    stage_profile(evaluator, profile, 0, 0, POSITIONS_NUM);
+    return staged_value(evaluator);
+}
+
+staged_evaluator make_staged_evaluator(double AllIn, double Bb, double Sb,
+        const ranges_equity_table& ranges_equities, const scenario_probability_table& scenario_probabilities){
+    staged_evaluator evaluator;
+    evaluator.AllIn = AllIn;
+    evaluator.ranges_equities = &ranges_equities;
+    evaluator.scenario_probabilities = &scenario_probabilities;
+
+    evaluator.fold_values[fold_nothing] = 0;
+    evaluator.fold_values[fold_steal_blinds] = (Sb + Bb);
+    evaluator.fold_values[fold_lose_small_blind] = (-Sb);
+    evaluator.fold_values[fold_win_big_blind] = (+Bb);
+    evaluator.fold_values[fold_win_small_blind] = (Sb);
+    evaluator.fold_values[fold_lose_big_blind] = (-Bb);
+
+    for(int scenario = 0; scenario < SCENARIOS_NUM; scenario++){
+        const scenario_payoff & payoff = scenario_payoffs[scenario];
+        double pot = payoff.all_ins * AllIn;
+        if(payoff.small_blind_dead) pot += Sb;
+        if(payoff.big_blind_dead) pot += Bb;
+        evaluator.pots[scenario] = pot;
+    }
+    return evaluator;
+}
+
+inline void stage_terms(staged_evaluator & evaluator, int scenario, double probability, const positions_equity * equity,
+        int first_seat, int last_seat){
+    evaluator.probabilities[scenario] = probability;
+    evaluator.equities[scenario] = equity;
+    const scenario_payoff & payoff = scenario_payoffs[scenario];
+    for(int seat = first_seat; seat < last_seat; seat++){
+        const seat_payoff seat_payoff = payoff.payoffs[seat];
+        evaluator.terms[scenario][seat] = seat_payoff >= all_in_equity_0 ?
+                probability * ((0.01) * (*equity)[seat_payoff - all_in_equity_0] * evaluator.pots[scenario] - evaluator.AllIn) :
+                probability * 1 * evaluator.fold_values[seat_payoff];
+    }
+}
+
+// one scenario of stage_profile, its keys and payoffs are constants of the instantiation
+template <int scenario, int first_seat, int last_seat>
+inline void stage_scenario(staged_evaluator & evaluator, const strategy_profile & profile){
+    constexpr const scenario_payoff & payoff = scenario_payoffs[scenario];
+    auto range = [&](int axis){ return axis < 0 ? 0 : profile.*strategy_axes[axis]; };
+    const int * keys = payoff.probability_axes;
+    const double probability = (0.01) * get_scenario_probability(*evaluator.scenario_probabilities,
+            range(keys[0]), range(keys[1]), range(keys[2]), range(keys[3]), Scenario(scenario));
+
+    const positions_equity * equity = nullptr;
+    if(scenario_all_in(scenario, first_seat, last_seat)){
+        keys = payoff.equity_axes;
+        equity = &get_ranges_equity(*evaluator.ranges_equities, range(keys[0]), range(keys[1]), range(keys[2]), range(keys[3]));
+    }
+    stage_terms(evaluator, scenario, probability, equity, first_seat, last_seat);
+}
+
+template <int first_seat, int last_seat, int... scenarios>
+inline void stage_scenarios(staged_evaluator & evaluator, const strategy_profile & profile, int first_axis,
+        integer_sequence<int, scenarios...>){
+    // a scenario whose keys only use axes outside of first_axis and its inner axes still holds the same terms
+    const int staged[] = {(scenario_level(scenarios) < first_axis ? 0 :
+                           (stage_scenario<scenarios, first_seat, last_seat>(evaluator, profile), 1))...};
+    (void)staged;
+}
+
+void stage_profile(staged_evaluator & evaluator, const strategy_profile & profile, int first_axis, int first_seat, int last_seat){
+    // the solvers stage either every position or a single one, anything else stages every position
+    const auto scenarios = make_integer_sequence<int, SCENARIOS_NUM>();
+    if(last_seat == first_seat + 1){
+        switch(first_seat){
+            case 0: stage_scenarios<0, 1>(evaluator, profile, first_axis, scenarios); return;
+            case 1: stage_scenarios<1, 2>(evaluator, profile, first_axis, scenarios); return;
+            case 2: stage_scenarios<2, 3>(evaluator, profile, first_axis, scenarios); return;
+            case 3: stage_scenarios<3, 4>(evaluator, profile, first_axis, scenarios); return;
+        }
+    }
+    stage_scenarios<0, POSITIONS_NUM>(evaluator, profile, first_axis, scenarios);
+}
+
+void restage_blinds(staged_evaluator & evaluator, const staged_evaluator & source, int first_axis){
+    // probabilities and equities do not depend on the blinds, so the terms come out as if the profile was staged here
+    for(int scenario = 0; scenario < SCENARIOS_NUM; scenario++){
+        if(scenario_level(scenario) >= first_axis){
+            stage_terms(evaluator, scenario, source.probabilities[scenario], source.equities[scenario], 0, POSITIONS_NUM);
+        }
+    }
+}
+
+positions_values staged_value(const staged_evaluator & evaluator){
+    // summed in scenario order like the formulas, so the values do not depend on which terms were kept
+    double total_probability = evaluator.probabilities[0];
+    positions_values iter_value = evaluator.terms[0];
+    for(int scenario = 1; scenario < SCENARIOS_NUM; scenario++){
+        total_probability += evaluator.probabilities[scenario];
+        for(int seat = 0; seat < POSITIONS_NUM; seat++){
+            iter_value[seat] += evaluator.terms[scenario][seat];
+        }
+    }
+
+    check_total_probability(total_probability);
+    check_value_sum(iter_value, evaluator.fold_values[fold_win_small_blind]);
+    return iter_value;
+}
+
+void check_total_probability(double total_probability){
+    if(abs(total_probability - 1.0) > 0.0015)
+    {
+        cout << "-E- Scenario probability too divergent, total value: " ;
+        cout << total_probability << endl;
+        throw exception();
+    }
+}
+
+void check_value_sum(const positions_values & iter_value, double Sb){
+    const double co_value = iter_value[0], de_value = iter_value[1], sb_value = iter_value[2], bb_value = iter_value[3];
+    double value_error = (Sb+!Sb)/10;
+    if(abs(co_value+de_value+sb_value+bb_value) > value_error){
+        cout << "-E- value_error too big, total value: " ;
+        cout << co_value + de_value + sb_value + bb_value << endl;
+        cout << co_value << "," << de_value << "," << sb_value << "," << bb_value << endl;
+        throw exception();
+    }
+}
+
+typedef void (*scenario_stager)(staged_evaluator & evaluator, const strategy_profile & profile);
+
+template <int first_seat, int last_seat, int... scenarios>
+const scenario_stager * scenario_stagers(integer_sequence<int, scenarios...>){
+    static const scenario_stager stagers[] = {&stage_scenario<scenarios, first_seat, last_seat>...};
+    return stagers;
+}
+
+staged_batch make_staged_batch(const staged_evaluator & evaluator, const strategy_space & space, int first_axis, int last_axis,
+        int first_seat, int last_seat){
+    staged_batch batch;
+    batch.evaluator = evaluator;
+    batch.space = &space;
+    batch.first_axis = first_axis;
+    batch.last_axis = last_axis;
+    batch.first_seat = first_seat;
+    batch.last_seat = last_seat;
+    batch.size = 1;
+    for(int axis = last_axis - 1; axis >= first_axis; axis--){
+        batch.strides[axis] = batch.size;
+        batch.size *= space.axes[axis].size();
+    }
+    for(int scenario = 0; scenario < SCENARIOS_NUM; scenario++){
+        batch.axes[scenario] = batch.levels[scenario] = -1;
+        for(int key = 0; key < POSITIONS_NUM; key++){
+            const int axis = scenario_payoffs[scenario].probability_axes[key];
+            if(axis >= first_axis && axis < last_axis){
+                batch.axes[scenario] = axis;
+            } else{
+                batch.levels[scenario] = max(batch.levels[scenario], axis);
+            }
+        }
+        const uint64_t ranges = batch.axes[scenario] < 0 ? 1 : space.axes[batch.axes[scenario]].size();
+        batch.probabilities[scenario].resize(ranges);
+        batch.equities[scenario].resize(ranges);
+        batch.terms[scenario].resize(ranges * (last_seat - first_seat));
+    }
+    for(int seat = first_seat; seat < last_seat; seat++){
+        batch.values[seat].resize(batch.size);
+    }
+    if(last_seat - first_seat == POSITIONS_NUM){
+        batch.total_probabilities.resize(batch.size);
+    }
+    batch.ready = false;
+    batch.changed = -1;
+    return batch;
+}
+
+template <bool first>
+inline void add_batch_terms(double * values, const double * terms, uint64_t repeats, uint64_t ranges, uint64_t stride){
+    // values is [repeat][range][stride], the innermost loop adds one term to a span or a span of terms to a span
+    if(stride == 1){
+        for(uint64_t repeat = 0; repeat < repeats; repeat++){
+            double * span = values + repeat * ranges;
+            for(uint64_t range = 0; range < ranges; range++){
+                span[range] = first ? terms[range] : span[range] + terms[range];
+            }
+        }
+        return;
+    }
+    for(uint64_t repeat = 0; repeat < repeats; repeat++){
+        for(uint64_t range = 0; range < ranges; range++){
+            const double term = terms[range];
+            double * span = values + (repeat * ranges + range) * stride;
+            for(uint64_t i = 0; i < stride; i++){
+                span[i] = first ? term : span[i] + term;
+            }
+        }
+    }
+}
+
+void sum_batch(staged_batch & batch){
+    // in scenario order, the first scenario sets the values like staged_value starts from its terms
+    for(int scenario = 0; scenario < SCENARIOS_NUM; scenario++){
+        const int axis = batch.axes[scenario];
+        const uint64_t ranges = batch.probabilities[scenario].size(), stride = axis < 0 ? batch.size : batch.strides[axis],
+                repeats = batch.size / (ranges * stride);
+        auto add = [&](double * values, const double * terms){
+            if(scenario == 0){
+                add_batch_terms<true>(values, terms, repeats, ranges, stride);
+            } else{
+                add_batch_terms<false>(values, terms, repeats, ranges, stride);
+            }
+        };
+        for(int seat = batch.first_seat; seat < batch.last_seat; seat++){
+            add(batch.values[seat].data(), &batch.terms[scenario][(seat - batch.first_seat) * ranges]);
+        }
+        if(!batch.total_probabilities.empty()){
+            add(batch.total_probabilities.data(), batch.probabilities[scenario].data());
+        }
+    }
+}
+
+void keep_batch_terms(staged_batch & batch, int scenario, uint64_t range){
+    const uint64_t ranges = batch.probabilities[scenario].size();
+    batch.probabilities[scenario][range] = batch.evaluator.probabilities[scenario];
+    batch.equities[scenario][range] = batch.evaluator.equities[scenario];
+    for(int seat = batch.first_seat; seat < batch.last_seat; seat++){
+        batch.terms[scenario][(seat - batch.first_seat) * ranges + range] = batch.evaluator.terms[scenario][seat];
+    }
+}
+
+void stage_batch(staged_batch & batch, const strategy_profile & profile){
+    // the ranges of the block come from the space, so only the axes out of it tell which scenarios still hold
+    int changed = batch.ready ? STRATEGY_AXES_NUM : -1;
+    for(int axis = 0; axis < STRATEGY_AXES_NUM && batch.ready; axis++){
+        if((axis < batch.first_axis || axis >= batch.last_axis) && profile.*strategy_axes[axis] != batch.staged.*strategy_axes[axis]){
+            changed = axis;
+            break;
+        }
+    }
+    batch.ready = true;
+    batch.changed = changed;
+    batch.staged = profile;
+    if(batch.changed == STRATEGY_AXES_NUM){
+        return;
+    }
+
+    const auto scenarios = make_integer_sequence<int, SCENARIOS_NUM>();
+    const scenario_stager * stagers = scenario_stagers<0, POSITIONS_NUM>(scenarios);
+    if(batch.last_seat == batch.first_seat + 1){
+        switch(batch.first_seat){
+            case 0: stagers = scenario_stagers<0, 1>(scenarios); break;
+            case 1: stagers = scenario_stagers<1, 2>(scenarios); break;
+            case 2: stagers = scenario_stagers<2, 3>(scenarios); break;
+            case 3: stagers = scenario_stagers<3, 4>(scenarios); break;
+        }
+    }
+    strategy_profile ranges_profile = profile;
+    for(int scenario = 0; scenario < SCENARIOS_NUM; scenario++){
+        if(batch.levels[scenario] < batch.changed){
+            continue;
+        }
+        const int axis = batch.axes[scenario];
+        if(axis < 0){
+            stagers[scenario](batch.evaluator, ranges_profile);
+            keep_batch_terms(batch, scenario, 0);
+            continue;
+        }
+        const positions_ranges & ranges = batch.space->axes[axis];
+        for(uint64_t range = 0; range < ranges.size(); range++){
+            ranges_profile.*strategy_axes[axis] = ranges[range];
+            stagers[scenario](batch.evaluator, ranges_profile);
+            keep_batch_terms(batch, scenario, range);
+        }
+        ranges_profile.*strategy_axes[axis] = profile.*strategy_axes[axis];
+    }
+    sum_batch(batch);
+}
+
+void restage_batch_blinds(staged_batch & batch, const staged_batch & source){
+    // the same block and positions as source, only the blinds differ, like restage_blinds
+    batch.ready = source.ready;
+    batch.changed = source.changed;
+    batch.staged = source.staged;
+    if(batch.changed == STRATEGY_AXES_NUM){
+        return;
+    }
+    for(int scenario = 0; scenario < SCENARIOS_NUM; scenario++){
+        if(source.levels[scenario] < source.changed){
+            continue;
+        }
+        for(uint64_t range = 0; range < source.probabilities[scenario].size(); range++){
+            stage_terms(batch.evaluator, scenario, source.probabilities[scenario][range], source.equities[scenario][range],
+                        batch.first_seat, batch.last_seat);
+            keep_batch_terms(batch, scenario, range);
+        }
+    }
+    sum_batch(batch);
+}
+
+positions_values batch_value(const staged_batch & batch, uint64_t profile){
+    positions_values iter_value;
+    for(int seat = 0; seat < POSITIONS_NUM; seat++){
+        iter_value[seat] = batch.values[seat][profile];
+    }
+    check_total_probability(batch.total_probabilities[profile]);
+    check_value_sum(iter_value, batch.evaluator.fold_values[fold_win_small_blind]);
+    return iter_value;
+}
+
+int batch_first_axis(const strategy_space & space, int first_axis, int last_axis, uint64_t max_profiles){
+    // an empty block, of one profile, when even the innermost axis has more ranges
+    int axis = last_axis;
+    while(axis > first_axis && strategy_space_size(space, axis - 1, last_axis) <= max_profiles){
+        axis--;
+    }
+    return axis;
+}
+
+deviation_engine make_deviation_engine(double AllIn, double Bb, double Sb,
+        const ranges_equity_table& ranges_equities, const scenario_probability_table& scenario_probabilities){
+    deviation_engine engine;
+    engine.evaluator = make_staged_evaluator(AllIn, Bb, Sb, ranges_equities, scenario_probabilities);
+    for(int seat = 0; seat < POSITIONS_NUM; seat++){
+        engine.batches[seat].space = nullptr;
+        engine.complete[seat] = false;
+        engine.checks[seat] = engine.short_circuits[seat] = engine.reuses[seat] = engine.evaluations[seat] = 0;
+    }
+    engine.payoffs = nullptr;
+    engine.blinds[0] = AllIn;
+    engine.blinds[1] = Sb;
+    engine.blinds[2] = Bb;
+    return engine;
+}
+
+int first_difference(const strategy_profile & profile, const strategy_profile & other){
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        if(profile.*strategy_axes[axis] != other.*strategy_axes[axis]){
+            return axis;
+        }
+    }
+    return STRATEGY_AXES_NUM;
+}
+
+void add_deviation_stats(deviation_engine & engine){
+    for(int seat = 0; seat < POSITIONS_NUM; seat++){
+        stats.deviation_checks[seat] += engine.checks[seat];
+        stats.deviation_short_circuits[seat] += engine.short_circuits[seat];
+        stats.deviation_reuses[seat] += engine.reuses[seat];
+        stats.deviation_evaluations[seat] += engine.evaluations[seat];
+        engine.checks[seat] = engine.short_circuits[seat] = engine.reuses[seat] = engine.evaluations[seat] = 0;
+    }
+}
+
+void record_phase(const string & phase, chrono::steady_clock::time_point start){
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    for(auto & entry : stats.phases){
+        if(entry.first == phase){
+            entry.second += seconds;
+            return;
+        }
+    }
+    stats.phases.emplace_back(phase, seconds);
+}
+
+void write_stats(){
+    ofstream file;
+    if(stats.path != "-"){
+        file.open(stats.path, ios::trunc);
+        if(!file.is_open()){
+            cerr << "-E- failed to open " << stats.path << " for writing" << endl;
+            return;
+        }
+    }
+    ostream & out = stats.path == "-" ? cerr : file;
+
+    auto write_seats = [&](const char * name, const atomic<uint64_t> * counters){
+        out << ",\"" << name << "\":[" << counters[0] << "," << counters[1] << "," << counters[2] << "," << counters[3] << "]";
+    };
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    out << "{\"wall_seconds\":" << chrono::duration<double>(chrono::steady_clock::now() - stats.start).count() << ",\"phases\":{";
+    for(size_t i = 0; i < stats.phases.size(); i++){
+        out << (i ? "," : "") << "\"" << stats.phases[i].first << "\":" << stats.phases[i].second;
+    }
+    out << "},\"sweep_profiles\":" << stats.sweep_profiles << ",\"profile_evaluations\":" << stats.profile_evaluations;
+    write_seats("deviation_checks", stats.deviation_checks);
+    write_seats("deviation_short_circuits", stats.deviation_short_circuits);
+    write_seats("deviation_reuses", stats.deviation_reuses);
+    write_seats("deviation_evaluations", stats.deviation_evaluations);
+    out << ",\"margin_iterations\":" << stats.margin_iterations << ",\"peak_rss_kb\":" << usage.ru_maxrss << "}" << endl;
+}
+
+uint64_t prune_dominated_ranges(const ranges_equity_table & ranges_equity, const scenario_probability_table & scenario_probability,
+        double AllIn, double SmallBlind, double BigBlind, double epsilon,
+        positions_ranges & co_range, positions_ranges & de_range, positions_ranges & de_co_range,
+        positions_ranges & sb_range, positions_ranges & sb_co_range, positions_ranges & sb_de_range, positions_ranges & sb_co_de_range,
+        positions_ranges & bb_co_range, positions_ranges & bb_de_range, positions_ranges & bb_sb_range,
+        positions_ranges & bb_co_de_range, positions_ranges & bb_co_sb_range, positions_ranges & bb_de_sb_range, positions_ranges & bb_co_de_sb_range){
+
+    strategy_space space = make_strategy_space(co_range, de_range, de_co_range, sb_range, sb_co_range, sb_de_range, sb_co_de_range,
+                                               bb_co_range, bb_de_range, bb_sb_range, bb_co_de_range, bb_co_sb_range, bb_de_sb_range, bb_co_de_sb_range);
+    const uint64_t total_iter = strategy_space_size(space, 0, STRATEGY_AXES_NUM);
+    staged_evaluator evaluator = make_staged_evaluator(AllIn, BigBlind, SmallBlind, ranges_equity, scenario_probability);
+
+    const auto start = chrono::steady_clock::now();
+    cout << "-I- Starting pruning of dominated ranges";
+    if(epsilon > 0){
+        cout << " (epsilon " << epsilon << ")";
+    }
+    cout << "..." << endl;
+
+    // a position's value is a sum over scenarios and an axis only shows up in the scenarios of its own decision, so
+    // the ranges of an axis compare on those terms alone, against every play of the axes the scenarios also use
+    bool pruned = true;
+    while(pruned){
+        pruned = false;
+        for(int seat = 0; seat < POSITIONS_NUM; seat++){
+            for(int axis = seat_axes[seat]; axis < seat_axes[seat + 1]; axis++){
+                positions_ranges & ranges = space.axes[axis];
+                if(ranges.size() < 2){
+                    continue;
+                }
+
+                bool scenarios[SCENARIOS_NUM], used[STRATEGY_AXES_NUM] = {};
+                for(int scenario = 0; scenario < SCENARIOS_NUM; scenario++){
+                    const int * keys = scenario_payoffs[scenario].probability_axes;
+                    scenarios[scenario] = find(keys, keys + POSITIONS_NUM, axis) != keys + POSITIONS_NUM;
+                    for(int key = 0; key < POSITIONS_NUM && scenarios[scenario]; key++){
+                        if(keys[key] >= 0) used[keys[key]] = true;
+                        if(scenario_payoffs[scenario].equity_axes[key] >= 0) used[scenario_payoffs[scenario].equity_axes[key]] = true;
+                    }
+                }
+
+                // the other axes keep their first range, they do not change the compared terms
+                strategy_space plays = space;
+                for(int other = 0; other < STRATEGY_AXES_NUM; other++){
+                    if(!used[other] || other == axis){
+                        plays.axes[other].resize(1);
+                    }
+                }
+                const uint64_t plays_num = strategy_space_size(plays, 0, STRATEGY_AXES_NUM);
+                if(plays_num * ranges.size() > total_iter / PRUNE_MAX_SHARE){
+                    continue;   // comparing would cost about as much as the sweep it saves
+                }
+
+                vector<double> values(ranges.size() * plays_num);
+                for(size_t range = 0; range < ranges.size(); range++){
+                    plays.axes[axis][0] = ranges[range];
+                    strategy_cursor cursor;
+                    cursor_seek(plays, cursor, 0, 0, STRATEGY_AXES_NUM);
+                    int changed = 0;
+                    for(uint64_t play = 0; play < plays_num; play++, changed = cursor_next(plays, cursor, 0, STRATEGY_AXES_NUM)){
+                        stage_profile(evaluator, cursor.profile, changed, seat, seat + 1);
+                        double value = 0;
+                        for(int scenario = 0; scenario < SCENARIOS_NUM; scenario++){
+                            if(scenarios[scenario]) value += evaluator.terms[scenario][seat];
+                        }
+                        values[range * plays_num + play] = value;
+                    }
+                }
+
+                // a range only falls to one that is still kept, so two ranges within epsilon do not remove each other
+                vector<bool> dominated(ranges.size(), false);
+                positions_ranges kept;
+                for(size_t range = 0; range < ranges.size(); range++){
+                    size_t by = 0;
+                    for(; by < ranges.size(); by++){
+                        if(by == range || dominated[by]){
+                            continue;
+                        }
+                        uint64_t play = 0;
+                        while(play < plays_num && values[by * plays_num + play] > values[range * plays_num + play] - epsilon){
+                            play++;
+                        }
+                        if(play == plays_num){
+                            break;
+                        }
+                    }
+                    if(by == ranges.size()){
+                        kept.push_back(ranges[range]);
+                    } else{
+                        dominated[range] = true;
+                        cout << "-I- " << strategy_axis_names[axis] << " range " << ranges[range] << " is dominated by "
+                             << ranges[by] << endl;
+                    }
+                }
+                if(kept.size() < ranges.size()){
+                    ranges = kept;
+                    pruned = true;
+                }
+            }
+        }
+    }
+
+    const uint64_t pruned_iter = strategy_space_size(space, 0, STRATEGY_AXES_NUM);
+    record_phase("prune", start);
+    cout << "-I- Pruned space: " << pruned_iter << " of " << total_iter << " iterations left ("
+         << 100.0 * pruned_iter / total_iter << "%)" << endl;
+
+    positions_ranges * const axes[STRATEGY_AXES_NUM] = {&co_range, &de_range, &de_co_range, &sb_range, &sb_co_range, &sb_de_range,
+            &sb_co_de_range, &bb_co_range, &bb_de_range, &bb_sb_range, &bb_co_de_range, &bb_co_sb_range, &bb_de_sb_range,
+            &bb_co_de_sb_range};
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        *axes[axis] = space.axes[axis];
+    }
+    return total_iter - pruned_iter;
+}
+
+payoff_table build_payoff_table(const ranges_equity_table & ranges_equity, const scenario_probability_table & scenario_probability,
+        const strategy_space & space, unsigned threads){
+    static_assert(sizeof(payoff_coefficients) == POSITIONS_NUM * BLIND_TERMS_NUM * sizeof(double), "payoff_coefficients must be packed doubles");
+    payoff_table table;
+    table.packer = make_profile_packer(space);
+
+    const uint64_t total_iter = strategy_space_size(space, 0, STRATEGY_AXES_NUM),
+            chunk_size = strategy_chunk_size(space, threads), chunks = total_iter / chunk_size;
+    auto coefficients = make_shared<vector<payoff_coefficients> >(total_iter);
+    table.coefficients = coefficients->data();
+    table.storage = coefficients;
+
+    cout << "-I- Building the payoff coefficients of " << total_iter << " profiles..." << endl;
+    progress_meter progress;
+    start_progress(progress, "payoff coefficients", "profiles", total_iter);
+
+    run_chunks(chunks, threads, [&](unsigned, uint64_t chunk){
+        // only the probabilities and equities of the evaluator are read, its blinds do not matter
+        staged_evaluator evaluator = make_staged_evaluator(1.0, 0.1, 0.05, ranges_equity, scenario_probability);
+        payoff_coefficients terms[SCENARIOS_NUM];
+        strategy_cursor cursor;
+        cursor_seek(space, cursor, chunk * chunk_size, 0, STRATEGY_AXES_NUM);
+        int changed = 0;
+        for(uint64_t i = 0; i < chunk_size; i++, changed = cursor_next(space, cursor, 0, STRATEGY_AXES_NUM)){
+            stage_profile(evaluator, cursor.profile, changed, 0, POSITIONS_NUM);
+            payoff_coefficients & profile_coefficients = (*coefficients)[chunk * chunk_size + i];
+            profile_coefficients = payoff_coefficients();
+            double total_probability = 0;
+            for(int scenario = 0; scenario < SCENARIOS_NUM; scenario++){
+                const double probability = evaluator.probabilities[scenario];
+                if(scenario_level(scenario) >= changed){
+                    // the terms of stage_terms, split into what multiplies AllIn, Sb and Bb
+                    const scenario_payoff & payoff = scenario_payoffs[scenario];
+                    const double pot[BLIND_TERMS_NUM] = {double(payoff.all_ins), double(payoff.small_blind_dead), double(payoff.big_blind_dead)};
+                    for(int seat = 0; seat < POSITIONS_NUM; seat++){
+                        const seat_payoff seat_payoff = payoff.payoffs[seat];
+                        for(int term = 0; term < BLIND_TERMS_NUM; term++){
+                            terms[scenario][seat][term] = seat_payoff >= all_in_equity_0 ?
+                                    probability * ((0.01) * (*evaluator.equities[scenario])[seat_payoff - all_in_equity_0] * pot[term] - (term == 0)) :
+                                    probability * fold_coefficients[seat_payoff][term];
+                        }
+                    }
+                }
+                total_probability += probability;
+                for(int seat = 0; seat < POSITIONS_NUM; seat++){
+                    for(int term = 0; term < BLIND_TERMS_NUM; term++){
+                        profile_coefficients[seat][term] += terms[scenario][seat][term];
+                    }
+                }
+            }
+            check_total_probability(total_probability);
+        }
+        report_progress(progress, chunk_size);
+    });
+    finish_progress(progress);
+    return table;
+}
+
+payoff_table load_payoff_table(const string & path, const ranges_equity_table & ranges_equity,
+        const scenario_probability_table & scenario_probability, const strategy_space & space, unsigned threads){
+    auto start = chrono::steady_clock::now();
+    const uint64_t tables_hash = tables_fingerprint(ranges_equity, scenario_probability);
+    payoff_table table;
+    table.coefficients = map_payoff_file(path, tables_hash, space, table);
+    if(table.coefficients){
+        record_phase("load", start);
+        cout << "-I- payoff coefficients mapped from " << path << ": " << strategy_space_size(table.packer.space, 0, STRATEGY_AXES_NUM)
+             << " profiles" << endl;
+        return table;
+    }
+
+    table = build_payoff_table(ranges_equity, scenario_probability, space, threads);
+    write_payoff_file(path, table, tables_hash);
+    record_phase("payoff_build", start);
+    cout << "-I- wrote the payoff coefficients of " << strategy_space_size(space, 0, STRATEGY_AXES_NUM) << " profiles to " << path << endl;
+    return table;
+}
+
+void write_payoff_file(const string & path, const payoff_table & table, uint64_t tables_hash){
+    // renamed over the old file like the table files, a run that has it mapped keeps reading the old one
+    const string temporary = path + ".tmp";
+    ofstream myfile(temporary, ios::binary | ios::trunc);
+    if(!myfile.is_open()){
+        cout << "-E- failed to open " << temporary << " for writing" << endl;
+        throw exception();
+    }
+
+    payoff_file_header header = payoff_file_header();
+    memcpy(header.magic, PAYOFF_FILE_MAGIC, sizeof(header.magic));
+    header.version = PAYOFF_FILE_VERSION;
+    header.byte_order = TABLE_FILE_BYTE_ORDER;
+    uint64_t ranges_num = 0;
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        header.axis_sizes[axis] = table.packer.space.axes[axis].size();
+        ranges_num += header.axis_sizes[axis];
+    }
+    header.tables_hash = tables_hash;
+    header.data_offset = (sizeof(header) + sizeof(int32_t) * ranges_num + 63) / 64 * 64;
+    myfile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        for(auto range : table.packer.space.axes[axis]){
+            int32_t value = range;
+            myfile.write(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+    }
+    const string padding(header.data_offset - sizeof(header) - sizeof(int32_t) * ranges_num, '\0');
+    myfile.write(padding.data(), padding.size());
+
+    myfile.write(reinterpret_cast<const char *>(table.coefficients),
+                 strategy_space_size(table.packer.space, 0, STRATEGY_AXES_NUM) * sizeof(payoff_coefficients));
+    myfile.close();
+    if(!myfile || rename(temporary.c_str(), path.c_str()) != 0){
+        cout << "-E- failed to write " << path << endl;
+        throw exception();
+    }
+}
+
+const payoff_coefficients * map_payoff_file(const string & path, uint64_t tables_hash, const strategy_space & space,
+        payoff_table & table){
+    shared_ptr<mapped_file> file = map_file(path);
+    if(!file){
+        return nullptr;
+    }
+
+    const char * base = static_cast<const char *>(file->data);
+    const payoff_file_header * header = reinterpret_cast<const payoff_file_header *>(base);
+    if(file->size < sizeof(payoff_file_header) || memcmp(header->magic, PAYOFF_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+       header->version != PAYOFF_FILE_VERSION || header->byte_order != TABLE_FILE_BYTE_ORDER){
+        cout << "-I- " << path << " is not a payoff file of this version, rebuilding it" << endl;
+        return nullptr;
+    }
+    if(header->tables_hash != tables_hash){
+        cout << "-I- " << path << " was built from other data files, rebuilding it" << endl;
+        return nullptr;
+    }
+
+    // an axis holds distinct ranges of 0 to MAX_RANGE, at least the ones of space; every size is checked before it is
+    // multiplied in and the data is compared with what is left of the file, so nothing here overflows
+    uint64_t ranges_num = 0, profiles = 1;
+    bool sizes_valid = true;
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        const uint64_t size = header->axis_sizes[axis];
+        if(size < space.axes[axis].size()){
+            cout << "-I- " << path << " has fewer " << strategy_axis_names[axis] << " ranges than the run, rebuilding it" << endl;
+            return nullptr;
+        }
+        if(size == 0 || size > MAX_RANGE + 1 || profiles > numeric_limits<uint64_t>::max() / size){
+            sizes_valid = false;
+            break;
+        }
+        ranges_num += size;
+        profiles *= size;
+    }
+    if(!sizes_valid || header->data_offset < sizeof(*header) || header->data_offset > file->size ||
+       header->data_offset % sizeof(double) != 0 || ranges_num > (header->data_offset - sizeof(*header)) / sizeof(int32_t) ||
+       profiles > (file->size - header->data_offset) / sizeof(payoff_coefficients)){
+        cout << "-E- invalid payoff file " << path << ", rebuilding it" << endl;
+        return nullptr;
+    }
+
+    // the file serves any space whose ranges it holds, e.g. the pruned ones or a narrower preset
+    const int32_t * ranges = reinterpret_cast<const int32_t *>(base + sizeof(*header));
+    strategy_space file_space;
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        file_space.axes[axis].assign(ranges, ranges + header->axis_sizes[axis]);
+        ranges += header->axis_sizes[axis];
+        for(auto range : file_space.axes[axis]){
+            if(range < 0 || range > MAX_RANGE){
+                cout << "-E- invalid range in payoff file " << path << ": " << range << ", rebuilding it" << endl;
+                return nullptr;
+            }
+        }
+    }
+    table.packer = make_profile_packer(file_space);
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        for(auto range : space.axes[axis]){
+            if(table.packer.index[axis][range] < 0){
+                cout << "-I- " << path << " has no " << strategy_axis_names[axis] << " range " << range << ", rebuilding it" << endl;
+                return nullptr;
+            }
+        }
+    }
+
+    table.storage = file;
+    return reinterpret_cast<const payoff_coefficients *>(base + header->data_offset);
+}
+
+uint64_t tables_fingerprint(const ranges_equity_table & ranges_equity, const scenario_probability_table & scenario_probability){
+    // fnv-1a over the range buckets and the dense tables, the same data gives the same hash from a text or a table file
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&](const void * data, size_t size){
+        const unsigned char * bytes = static_cast<const unsigned char *>(data);
+        for(size_t i = 0; i < size; i++){
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    uint64_t equity_entries = 1, probability_entries = 1;
+    for(int key = 0; key < POSITIONS_NUM; key++){
+        add(ranges_equity.buckets[key].values.data(), ranges_equity.buckets[key].values.size() * sizeof(int));
+        add(scenario_probability.buckets[key].values.data(), scenario_probability.buckets[key].values.size() * sizeof(int));
+        equity_entries *= ranges_equity.buckets[key].values.size();
+        probability_entries *= scenario_probability.buckets[key].values.size();
+    }
+    add(ranges_equity.equities, equity_entries * sizeof(positions_equity));
+    add(scenario_probability.probabilities, probability_entries * SCENARIOS_NUM * sizeof(double));
+    return hash;
+}
+
+profile_packer make_profile_packer(const strategy_space & space){
+    profile_packer packer;
+    packer.space = space;
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        fill(packer.index[axis], packer.index[axis] + MAX_RANGE + 1, -1);
+        for(size_t i = 0; i < space.axes[axis].size(); i++){
+            packer.index[axis][space.axes[axis][i]] = i;
+        }
+    }
+    return packer;
+}
+
+packed_profile pack_profile(const profile_packer & packer, const strategy_profile & profile){
+    // the cursor the sweeps would have at this profile, only its candidate indexes are needed
+    strategy_cursor cursor;
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        cursor.index[axis] = packer.index[axis][profile.*strategy_axes[axis]];
+    }
+    return strategy_position(packer.space, cursor);
+}
+
+strategy_profile unpack_profile(const strategy_space & space, packed_profile profile){
+    strategy_cursor cursor;
+    cursor_seek(space, cursor, profile, 0, STRATEGY_AXES_NUM);
+    return cursor.profile;
+}
+
+positions_values payoff_value(const payoff_coefficients & coefficients, const blind_config & blinds){
+    positions_values iter_value;
+    for(int seat = 0; seat < POSITIONS_NUM; seat++){
+        iter_value[seat] = coefficients[seat][0] * blinds.all_in + coefficients[seat][1] * blinds.small_blind +
+                           coefficients[seat][2] * blinds.big_blind;
+    }
+    check_value_sum(iter_value, blinds.small_blind);
+    return iter_value;
+}
+
+double payoff_seat_value(const payoff_coefficients & coefficients, const double * blinds, int seat){
+    return coefficients[seat][0] * blinds[0] + coefficients[seat][1] * blinds[1] + coefficients[seat][2] * blinds[2];
+}
+
+/*
+ * input: AllIn, Bb, Sb,
+ *        co_range, de_range, sb_range,
+ *        de_co_range, sb_co_range, sb_de_range, bb_co_range, bb_de_range, bb_sb_range,
+ *        sb_co_de_range, bb_co_de_range, bb_co_sb_range, bb_de_sb_range,
+ *        bb_co_de_sb_range
+ *
+ * CO = P{CO_not, DE_not, SB_not}                   * E{1} * 0                                                                  +       (empty)
+ *      P{CO, DE_CO_not, SB_CO_not, BB_CO_not}      * E{1} * Bb+Sb                                                              +       (only co)
+ *      P{CO_not, DE, SB_DE_not, BB_DE_not}         * E{1} * 0                                                                  +       (only de)
+ *      P{CO_not, DE_not, SB, BB_SB_not}            * E{1} * 0                                                                  +       (only sb)
+ *      P{CO, DE_CO, SB_CO_DE_not, BB_CO_DE_not}    * E{co_range, de_co_range} * (2*AllIn + Bb + Sb)                            +       (co vs de)
+ *      P{CO, DE_CO_not, SB_CO, BB_CO_SB_not}       * E{co_range, sb_co_range} * (2*AllIn + Bb)                                 +       (co vs sb)
+ *      P{CO, DE_CO_not, SB_CO_not, BB_CO}          * E{co_range, bb_co_range} * (2*AllIn + Sb)                                 +       (co vs bb)
+ *      P{CO_not, DE, SB_DE, BB_DE_SB_not}          * E{1} * 0                                                                  +       (de vs sb)
+ *      P{CO_not, DE, SB_DE_not, BB_DE}             * E{1} * 0                                                                  +       (de vs bb)
+ *      P{CO_not, DE_not, SB, BB_SB}                * E{1} * 0                                                                  +       (sb vs bb)
+ *      P{CO, DE_CO, SB_CO_DE, BB_CO_DE_SB_not}     * E{co_range, de_co_range, sb_co_de_range} * (3*AllIn + Bb)                 +       (co vs de vs sb)
+ *      P{CO, DE_CO, SB_CO_DE_not, BB_CO_DE}        * E{co_range, de_co_range, bb_co_de_range} * (3*AllIn + Sb)                 +       (co vs de vs bb)
+ *      P{CO, DE_CO_not, SB_CO, BB_CO_SB}           * E{co_range, sb_co_range, bb_co_sb_range} * (3*AllIn)                      +       (co vs sb vs bb)
+ *      P{CO_not, DE, SB_DE, BB_DE_SB}              * E{1} * 0                                                                  +       (de vs sb vs bb)
+ *      P{CO, DE_CO, SB_CO_DE, BB_CO_DE_SB}         * E{co_range, de_co_range, sb_co_de_range, bb_co_de_sb_range} * (4*AllIn)   +       (co vs de vs sb vs bb)
+ *
+ *
+ * DE = P{CO_not, DE_not, SB_not}                   * E{1} * 0                      +       (empty)
+ *      P{CO, DE_CO_not, SB_CO_not, BB_CO_not}      * E{1} * 0                      +       (only co)
+ *      P{CO_not, DE, SB_DE_not, BB_DE_not}         * E{1} * Bb+Sb                  +       (only de)
+ *      P{CO_not, DE_not, SB, BB_SB_not}            * E{1} * 0                      +       (only sb)
+ *      P{CO, DE_CO, SB_CO_DE_not, BB_CO_DE_not}    * E{} * X                       +       (co vs de)
+ *      P{CO, DE_CO_not, SB_CO, BB_CO_SB_not}       * E{1} * 0                      +       (co vs sb)
+ *      P{CO, DE_CO_not, SB_CO_not, BB_CO}          * E{1} * 0                      +       (co vs bb)
+ *      P{CO_not, DE, SB_DE, BB_DE_SB_not}          * E{} * X                       +       (de vs sb)
+ *      P{CO_not, DE, SB_DE_not, BB_DE}             * E{} * X                       +       (de vs bb)
+ *      P{CO_not, DE_not, SB, BB_SB}                * E{1} * 0                      +       (sb vs bb)
+ *      P{CO, DE_CO, SB_CO_DE, BB_CO_DE_SB_not}     * E{} * X                       +       (co vs de vs sb)
+ *      P{CO, DE_CO, SB_CO_DE_not, BB_CO_DE}        * E{} * X                       +       (co vs de vs bb)
+ *      P{CO, DE_CO_not, SB_CO, BB_CO_SB}           * E{1} * 0                      +       (co vs sb vs bb)
+ *      P{CO_not, DE, SB_DE, BB_DE_SB}              * E{} * X                       +       (de vs sb vs bb)
+ *      P{CO, DE_CO, SB_CO_DE, BB_CO_DE_SB}         * E{} * X                       +       (co vs de vs sb vs bb)
+ *
+ *
+ * SB = P{CO_not, DE_not, SB_not}                   * E{1} * (-Sb)                  +       (empty)
+ *      P{CO, DE_CO_not, SB_CO_not, BB_CO_not}      * E{1} * (-Sb)                  +       (only co)
+ *      P{CO_not, DE, SB_DE_not, BB_DE_not}         * E{1} * (-Sb)                  +       (only de)
+ *      P{CO_not, DE_not, SB, BB_SB_not}            * E{1} * Bb                     +       (only sb)
+ *      P{CO, DE_CO, SB_CO_DE_not, BB_CO_DE_not}    * E{1} * (-Sb)                  +       (co vs de)
+ *      P{CO, DE_CO_not, SB_CO, BB_CO_SB_not}       * E{} * X                       +       (co vs sb)
+ *      P{CO, DE_CO_not, SB_CO_not, BB_CO}          * E{1} * (-Sb)                  +       (co vs bb)
+ *      P{CO_not, DE, SB_DE, BB_DE_SB_not}          * E{} * X                       +       (de vs sb)
+ *      P{CO_not, DE, SB_DE_not, BB_DE}             * E{1} * (-Sb)                  +       (de vs bb)
+ *      P{CO_not, DE_not, SB, BB_SB}                * E{} * X                       +       (sb vs bb)
+ *      P{CO, DE_CO, SB_CO_DE, BB_CO_DE_SB_not}     * E{} * X                       +       (co vs de vs sb)
+ *      P{CO, DE_CO, SB_CO_DE_not, BB_CO_DE}        * E{1} * (-Sb)                  +       (co vs de vs bb)
+ *      P{CO, DE_CO_not, SB_CO, BB_CO_SB}           * E{} * X                       +       (co vs sb vs bb)
+ *      P{CO_not, DE, SB_DE, BB_DE_SB}              * E{} * X                       +       (de vs sb vs bb)
+ *      P{CO, DE_CO, SB_CO_DE, BB_CO_DE_SB}         * E{} * X                       +       (co vs de vs sb vs bb)
+ *
+ *
+ * BB = P{CO_not, DE_not, SB_not}                   * E{+Sb} * Sb                   +       (empty)
+ *      P{CO, DE_CO_not, SB_CO_not, BB_CO_not}      * E{1} * (-Bb)                  +       (only co)
+ *      P{CO_not, DE, SB_DE_not, BB_DE_not}         * E{1} * (-Bb)                  +       (only de)
+ *      P{CO_not, DE_not, SB, BB_SB_not}            * E{1} * (-Bb)                  +       (only sb)
+ *      P{CO, DE_CO, SB_CO_DE_not, BB_CO_DE_not}    * E{1} * (-Bb)                  +       (co vs de)
+ *      P{CO, DE_CO_not, SB_CO, BB_CO_SB_not}       * E{1} * (-Bb)                  +       (co vs sb)
+ *      P{CO, DE_CO_not, SB_CO_not, BB_CO}          * E{} * X                       +       (co vs bb)
+ *      P{CO_not, DE, SB_DE, BB_DE_SB_not}          * E{1} * (-Bb)                  +       (de vs sb)
+ *      P{CO_not, DE, SB_DE_not, BB_DE}             * E{} * X                       +       (de vs bb)
+ *      P{CO_not, DE_not, SB, BB_SB}                * E{} * X                       +       (sb vs bb)
+ *      P{CO, DE_CO, SB_CO_DE, BB_CO_DE_SB_not}     * E{1} * (-Bb)                  +       (co vs de vs sb)
+ *      P{CO, DE_CO, SB_CO_DE_not, BB_CO_DE}        * E{} * X                       +       (co vs de vs bb)
+ *      P{CO, DE_CO_not, SB_CO, BB_CO_SB}           * E{} * X                       +       (co vs sb vs bb)
+ *      P{CO_not, DE, SB_DE, BB_DE_SB}              * E{} * X                       +       (de vs sb vs bb)
+ *      P{CO, DE_CO, SB_CO_DE, BB_CO_DE_SB}         * E{} * X                       +       (co vs de vs sb vs bb)
+ *
+ */
+
+
@@ -0,0 +1,765 @@
+#ifndef NASH_EQ_CALC_H
+#define NASH_EQ_CALC_H
+
+#include <iostream>
+#include <tuple>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <map>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iomanip>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <unordered_map>
+#include <memory>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <csignal>
+#include <sstream>
+#include <utility>
+#include <chrono>
+#include <sys/resource.h>
+#include <cstdio>
+
+using namespace std;
+
+/* Enums & typedefs:
+ *      1. enum Scenario - list of all the AllIn/Fold combinations
+ *      2. positions_expectancy - vector (of 4) doubles each represent the expected value of each positions
+ *      3. positions_ranges - vector (of 4) ints each represent the range of the corresponding position
+ *      4. position_strategy - vector of diffrent size represent the strategy of each position
+ *      5. map_scenario_probability - map between ranges & scenario to the probability of that event happening
+ *      6. map_ranges_equity - map between ranges and the equity of each one in case of action
+ *      7. map_strategy_value - map between strategy and excpected value for specific position
+ *      8. map_strategy_values - map between strategy and excpected value for all the positions
+ *      9. range_buckets - dense index of the range values of one table key, the values of a data file or of a run
+ *      10. scenario_probability_table - flat (co, de, sb, bb, scenario) probability table indexed by range buckets
+ *      11. positions_equity - array (of 4) doubles each represent the equity of the corresponding position
+ *      12. ranges_equity_table - flat (co, de, sb, bb) equity table indexed by range buckets, already in seat order
+ *      13. positions_values - array (of 4) doubles each represent the expected value of each positions
+ *      14. strategy_profile - the 14 ranges of one iteration, in the order of the solvers loops
+ *      15. strategy_axes - the strategy_profile fields by loop depth, seat_axes - the first axis of each position
+ *      16. strategy_space - the candidate ranges of every strategy_profile field
+ *      17. strategy_cursor - a strategy_profile together with its candidate index on every axis
+ *      18. run_options - command line flags (--threads N, --prune, ...)
+ *      19. nash_candidate - a profile that may be a nash point, with its values and relative regret
+ *      20. table_file_header / mapped_file / unique_fd - binary table file layout, a read only mapping of a file and a file
+ *          descriptor closed with its scope
+ *      21. text_scanner - the unread part of one line of a text data file
+ *      22. seat_payoff / scenario_payoff - one scenario of calc_iteration_value: its probability and equity keys as
+ *          profile axes, the all in pot and what every position gets out of it
+ *      23. staged_evaluator - calc_iteration_value terms of every scenario, kept between neighbouring profiles
+ *      24. deviation_engine - values of every strategy of one position against fixed opponents, per position
+ *      25. run_stats / stats - phase timings and hot path counters of the run, written by --stats
+ *      26. progress_meter - shared counter of a sweep or a load and the thread that reports it, stopped with its scope
+ *      27. blind_config - the all in and blinds sizes of one solve, a list of them is read by --blinds
+ *      28. payoff_coefficients - the all in, small blind and big blind coefficient of every position's value
+ *      29. payoff_table / payoff_file_header - payoff_coefficients of every profile of a strategy_space / its --payoff-cache
+ *          file layout
+ *      30. result_sink - where the nash points go: a csv written as they are confirmed and, with --top, the least regret
+ *          ones in memory
+ *      31. packed_profile / profile_packer - a strategy_profile as one integer, its strategy_position in a strategy_space /
+ *          the space with the candidate index of every range, to pack profiles that come without a cursor
+ *      32. sweep_file_header / sweep_state - --checkpoint file layout / what the swept chunks of a Nash or MinMax sweep left
+ *      33. sweep_checkpoint / sweep_saver - where and how often a sweep is saved, which shard of it to sweep and the files
+ *          to merge instead / the chunks every worker swept and the locks that keep a saved state consistent with them
+ *      34. staged_batch - calc_iteration_value of every profile of a block of one position's axes at once, as structure of
+ *          arrays
+ *
+ */
+
+enum Scenario {empty_bigblind=0, oneraise_cutoff, oneraise_dealer, oneraise_smallblind,
+    tworaises_cutoff_dealer, tworaises_cutoff_smallblind, tworaises_cutoff_bigblind, tworaises_dealer_smallblind,
+    tworaises_dealer_bigblind, tworaises_smallblind_bigblind, threeraises_cutoff_dealer_smallblind,
+    threeraises_cutoff_dealer_bigblind, threeraises_cutoff_smallblind_bigblind, threeraises_dealer_smallblind_bigblind,
+    fourraises_cutoff_dealer_smallblind_bigblind        } ;
+
+const char * const scenario_names[] = {"empty_bigblind", "oneraise_cutoff", "oneraise_dealer", "oneraise_smallblind",
+    "tworaises_cutoff_dealer", "tworaises_cutoff_smallblind", "tworaises_cutoff_bigblind", "tworaises_dealer_smallblind",
+    "tworaises_dealer_bigblind", "tworaises_smallblind_bigblind", "threeraises_cutoff_dealer_smallblind",
+    "threeraises_cutoff_dealer_bigblind", "threeraises_cutoff_smallblind_bigblind", "threeraises_dealer_smallblind_bigblind",
+    "fourraises_cutoff_dealer_smallblind_bigblind"};
+
+typedef vector<double> positions_expectancy;
+typedef vector<int> positions_ranges;
+typedef vector<int> position_strategy;
+typedef map<tuple< positions_ranges, Scenario >, double > map_scenario_probability;
+typedef map<positions_ranges, positions_expectancy > map_ranges_equity;
+typedef map<position_strategy, double> map_strategy_value;
+typedef map<position_strategy, positions_expectancy> map_strategy_values;
+typedef array<double, 4> positions_equity;
+typedef array<double, 4> positions_values;
+
+#define EQUITY_ERROR 0.15
+#define EQUITY_DATA_FILE "./../equity_dict_data.txt"
+#define FREQUENCY_DATA_FILE "./../frequency_dict_data.txt"
+#define EQUITY_DATA_FILE_ENV "NASH_EQUITY_FILE"
+#define FREQUENCY_DATA_FILE_ENV "NASH_FREQUENCY_FILE"
+#define MAX_RANGE 100
+#define SCENARIOS_NUM (fourraises_cutoff_dealer_smallblind_bigblind + 1)
+#define POSITIONS_NUM 4
+
+struct range_buckets {
+    int index[MAX_RANGE + 1];       // bucket index of each range value, -1 if the value is not in the data
+    vector<int> values;             // range value of each bucket, ascending
+};
+
+// the tables of the data files use the same buckets for every key, the ones interpolated for a run only the ranges it uses
+struct scenario_probability_table {
+    range_buckets buckets[POSITIONS_NUM];
+    const double * probabilities;   // [table_entry(co, de, sb, bb)][scenario], NaN where the data has no entry
+    shared_ptr<const void> storage; // owns probabilities, either a vector or a mapped table file
+};
+
+struct strategy_profile {
+    int co_range;
+    int de_range, de_co_range;
+    int sb_range, sb_co_range, sb_de_range, sb_co_de_range;
+    int bb_co_range, bb_de_range, bb_sb_range, bb_co_de_range, bb_co_sb_range, bb_de_sb_range, bb_co_de_sb_range;
+};
+
+struct ranges_equity_table {
+    range_buckets buckets[POSITIONS_NUM];
+    const positions_equity * equities;  // [table_entry(co, de, sb, bb)], NaN where the data has no entry
+    shared_ptr<const void> storage;     // owns equities, either a vector or a mapped table file
+};
+
+/* Binary table files: a table_file_header, the range bucket axis (int32 per bucket), the value axis (int32 per value:
+ * the Scenario of each probability or the position of each equity) and, from data_offset, the dense table itself
+ * as native doubles in the layout of scenario_probability_table / ranges_equity_table. Produced by "convert", and rebuilt
+ * from the text file it was converted from once that file changes. */
+#define TABLE_FILE_MAGIC "NEQTABLE"
+#define TABLE_FILE_VERSION 2
+#define TABLE_FILE_BYTE_ORDER 0x01020304u
+
+enum table_kind {equity_table_kind=1, probability_table_kind};
+
+struct table_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t kind;
+    uint32_t buckets_num;
+    uint32_t values_num;
+    uint32_t reserved;
+    uint64_t data_offset;
+    uint64_t source_size;       // size and modification time (ns) of the text file it was converted from
+    int64_t source_mtime;
+};
+
+struct mapped_file {
+    void * data = MAP_FAILED;
+    size_t size = 0;
+    ~mapped_file(){ if(data != MAP_FAILED) munmap(data, size); }
+};
+
+struct unique_fd {
+    int fd;
+    explicit unique_fd(int fd) : fd(fd) {}
+    unique_fd(const unique_fd &) = delete;
+    unique_fd & operator=(const unique_fd &) = delete;
+    ~unique_fd(){ if(fd >= 0) close(fd); }
+};
+
+struct text_scanner {
+    const char * pos;
+    const char * end;
+};
+
+#define STRATEGY_AXES_NUM 14
+#define MARGIN_TOLERANCE 1e-9
+#define PRUNE_MAX_SHARE 4          // an axis is only checked for dominated ranges if that costs under 1/4 of a sweep
+
+constexpr int strategy_profile::* strategy_axes[STRATEGY_AXES_NUM] = {
+        &strategy_profile::co_range,
+        &strategy_profile::de_range, &strategy_profile::de_co_range,
+        &strategy_profile::sb_range, &strategy_profile::sb_co_range, &strategy_profile::sb_de_range, &strategy_profile::sb_co_de_range,
+        &strategy_profile::bb_co_range, &strategy_profile::bb_de_range, &strategy_profile::bb_sb_range, &strategy_profile::bb_co_de_range,
+        &strategy_profile::bb_co_sb_range, &strategy_profile::bb_de_sb_range, &strategy_profile::bb_co_de_sb_range};
+const int seat_axes[POSITIONS_NUM + 1] = {0, 1, 3, 7, STRATEGY_AXES_NUM};
+const char * const strategy_axis_names[STRATEGY_AXES_NUM] = {"co", "de", "de_co", "sb", "sb_co", "sb_de", "sb_co_de",
+        "bb_co", "bb_de", "bb_sb", "bb_co_de", "bb_co_sb", "bb_de_sb", "bb_co_de_sb"};
+
+struct strategy_space {
+    positions_ranges axes[STRATEGY_AXES_NUM];
+};
+
+struct strategy_cursor {
+    int index[STRATEGY_AXES_NUM];
+    strategy_profile profile;
+};
+
+enum seat_payoff {fold_nothing=0, fold_steal_blinds, fold_lose_small_blind, fold_win_big_blind, fold_win_small_blind,
+    fold_lose_big_blind, all_in_equity_0, all_in_equity_1, all_in_equity_2, all_in_equity_3};
+
+struct scenario_payoff {
+    int probability_axes[POSITIONS_NUM];    // -1 stands for a 0 range
+    int equity_axes[POSITIONS_NUM];
+    int all_ins;
+    bool small_blind_dead, big_blind_dead;
+    seat_payoff payoffs[POSITIONS_NUM];
+};
+
+// the rows of calc_iteration_value, see the formulas at the bottom of nash_eq_calc.cpp
+constexpr scenario_payoff scenario_payoffs[SCENARIOS_NUM] = {
+        {{0, 1, 3, -1},  {-1, -1, -1, -1}, 0, false, false, {fold_nothing, fold_nothing, fold_lose_small_blind, fold_win_small_blind}},
+        {{0, 2, 4, 7},   {-1, -1, -1, -1}, 0, false, false, {fold_steal_blinds, fold_nothing, fold_lose_small_blind, fold_lose_big_blind}},
+        {{0, 1, 5, 8},   {-1, -1, -1, -1}, 0, false, false, {fold_nothing, fold_steal_blinds, fold_lose_small_blind, fold_lose_big_blind}},
+        {{0, 1, 3, 9},   {-1, -1, -1, -1}, 0, false, false, {fold_nothing, fold_nothing, fold_win_big_blind, fold_lose_big_blind}},
+        {{0, 2, 6, 10},  {-1, -1, 0, 2},   2, true, true,   {all_in_equity_2, all_in_equity_3, fold_lose_small_blind, fold_lose_big_blind}},
+        {{0, 2, 4, 11},  {-1, -1, 0, 4},   2, false, true,  {all_in_equity_2, fold_nothing, all_in_equity_3, fold_lose_big_blind}},
+        {{0, 2, 4, 7},   {-1, -1, 0, 7},   2, true, false,  {all_in_equity_2, fold_nothing, fold_lose_small_blind, all_in_equity_3}},
+        {{0, 1, 5, 12},  {-1, -1, 1, 5},   2, false, true,  {fold_nothing, all_in_equity_2, all_in_equity_3, fold_lose_big_blind}},
+        {{0, 1, 5, 8},   {-1, -1, 1, 8},   2, true, false,  {fold_nothing, all_in_equity_2, fold_lose_small_blind, all_in_equity_3}},
+        {{0, 1, 3, 9},   {-1, -1, 3, 9},   2, false, false, {fold_nothing, fold_nothing, all_in_equity_2, all_in_equity_3}},
+        {{0, 2, 6, 13},  {-1, 0, 2, 6},    3, false, true,  {all_in_equity_1, all_in_equity_2, all_in_equity_3, fold_lose_big_blind}},
+        {{0, 2, 6, 10},  {-1, 0, 2, 10},   3, true, false,  {all_in_equity_1, all_in_equity_2, fold_lose_small_blind, all_in_equity_3}},
+        {{0, 2, 4, 11},  {-1, 0, 4, 11},   3, false, false, {all_in_equity_1, fold_nothing, all_in_equity_2, all_in_equity_3}},
+        {{0, 1, 5, 12},  {-1, 1, 5, 12},   3, false, false, {fold_nothing, all_in_equity_1, all_in_equity_2, all_in_equity_3}},
+        {{0, 2, 6, 13},  {0, 2, 6, 13},    4, false, false, {all_in_equity_0, all_in_equity_1, all_in_equity_2, all_in_equity_3}}};
+
+// innermost profile axis a scenario depends on
+constexpr int scenario_level(int scenario){
+    int level = -1;
+    for(int key = 0; key < POSITIONS_NUM; key++){
+        level = max(level, scenario_payoffs[scenario].probability_axes[key]);
+    }
+    return level;
+}
+
+// whether one of the positions first_seat to last_seat is all in, i.e. the scenario needs its equities
+constexpr bool scenario_all_in(int scenario, int first_seat, int last_seat){
+    for(int seat = first_seat; seat < last_seat; seat++){
+        if(scenario_payoffs[scenario].payoffs[seat] >= all_in_equity_0){
+            return true;
+        }
+    }
+    return false;
+}
+
+struct staged_evaluator {
+    double AllIn;
+    const ranges_equity_table * ranges_equities;
+    const scenario_probability_table * scenario_probabilities;
+    double fold_values[all_in_equity_0];
+    double pots[SCENARIOS_NUM];
+    double probabilities[SCENARIOS_NUM];
+    const positions_equity * equities[SCENARIOS_NUM];   // nullptr where no staged position is all in
+    positions_values terms[SCENARIOS_NUM];
+};
+
+/* A position's key of a scenario is exactly one of its axes, so a scenario reaches at most one axis of a block of the
+ * same position's axes. Its terms are staged once per range of that axis and added to every profile of the block, in
+ * scenario order like staged_value so the values are the same to the bit. The values are kept per position over the
+ * profiles of the block and every sum runs over a contiguous span of them, so the compiler vectorizes it. */
+#define BATCH_MAX_PROFILES 4096         // the profiles of a staged_batch, its values stay in the cache
+
+struct staged_batch {
+    staged_evaluator evaluator;                     // the blinds, and the scenario being staged
+    const strategy_space * space;
+    int first_axis, last_axis;                      // the block, the other axes come from the staged profile
+    int first_seat, last_seat;                      // the positions whose terms are staged
+    uint64_t size;                                  // profiles of the block
+    uint64_t strides[STRATEGY_AXES_NUM];            // profiles of the block between two ranges of one of its axes
+    int axes[SCENARIOS_NUM];                        // the axis of the block a scenario reaches, -1 for none
+    int levels[SCENARIOS_NUM];                      // innermost axis out of the block a scenario reaches, -1 for none
+    bool ready;                                     // a profile was staged
+    strategy_profile staged;
+    int changed;                                    // outermost axis out of the block the last profile changed, -1 at first
+    vector<double> probabilities[SCENARIOS_NUM];    // [range index on the scenario's axis]
+    vector<const positions_equity *> equities[SCENARIOS_NUM];
+    vector<double> terms[SCENARIOS_NUM];            // [staged position][range index on the scenario's axis]
+    vector<double> values[POSITIONS_NUM];           // [profile of the block], in cursor order
+    vector<double> total_probabilities;             // only when every position is staged
+};
+
+// every value of calc_iteration_value is linear in AllIn, Sb and Bb, the coefficients are in this order
+#define BLIND_TERMS_NUM 3
+typedef array<array<double, BLIND_TERMS_NUM>, POSITIONS_NUM> payoff_coefficients;
+
+// fold_values as coefficients of AllIn, Sb and Bb
+constexpr double fold_coefficients[all_in_equity_0][BLIND_TERMS_NUM] = {
+        {0, 0, 0}, {0, 1, 1}, {0, -1, 0}, {0, 0, 1}, {0, 1, 0}, {0, 0, -1}};
+
+// the candidate index of every axis in mixed radix, outermost axis first, so packed profiles sort like the sweeps visit them
+typedef uint64_t packed_profile;
+
+struct profile_packer {
+    strategy_space space;
+    int index[STRATEGY_AXES_NUM][MAX_RANGE + 1];    // index of a range value on each axis of space, -1 if it has none
+};
+
+struct payoff_table {
+    profile_packer packer;
+    const payoff_coefficients * coefficients;       // [packed_profile]
+    shared_ptr<const void> storage;                 // owns coefficients, either a vector or a mapped payoff file
+};
+
+/* Payoff files: a payoff_file_header, the ranges of every axis of the space (int32 per range, axis after axis) and, from
+ * data_offset, the payoff_coefficients of every profile as native doubles. Written and reused by --payoff-cache. */
+#define PAYOFF_FILE_MAGIC "NEQPAYOF"
+#define PAYOFF_FILE_VERSION 1
+
+struct payoff_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t axis_sizes[STRATEGY_AXES_NUM];
+    uint64_t tables_hash;       // tables_fingerprint of the equity and probability tables the coefficients come from
+    uint64_t data_offset;
+};
+
+struct deviation_engine {
+    staged_evaluator evaluator;                     // the blinds of the batches
+    staged_batch batches[POSITIONS_NUM];            // each one only stages the terms of its own position, over its axes
+    strategy_profile staged[POSITIONS_NUM];
+    bool complete[POSITIONS_NUM];                   // best holds the best deviation against the staged opponents
+    double best[POSITIONS_NUM];
+    uint64_t checks[POSITIONS_NUM], short_circuits[POSITIONS_NUM], reuses[POSITIONS_NUM];   // counted for run_stats
+    uint64_t evaluations[POSITIONS_NUM];
+    const payoff_table * payoffs;                   // when set the deviations are read from it instead of staged
+    double blinds[BLIND_TERMS_NUM];
+};
+
+// what --stats writes as json at exit, the solvers add their counters once per chunk or per solve
+struct run_stats {
+    string path;                                    // "-" for stderr, empty when --stats is not given
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<pair<string, double> > phases;           // seconds, summed over the solves of a serve run
+    atomic<uint64_t> sweep_profiles{0};
+    atomic<uint64_t> profile_evaluations{0};        // values of whole profiles: swept, batched, from payoffs or calc_iteration_value
+    atomic<uint64_t> deviation_checks[POSITIONS_NUM], deviation_short_circuits[POSITIONS_NUM], deviation_reuses[POSITIONS_NUM];
+    atomic<uint64_t> deviation_evaluations[POSITIONS_NUM];     // values of one position's deviations summed or read
+    atomic<uint64_t> margin_iterations{0};
+};
+
+extern run_stats stats;
+
+// progress of a sweep or a file load: the workers only add to done, a reporter thread prints it twice a second
+struct progress_meter {
+    string name, unit;
+    uint64_t total;
+    atomic<uint64_t> done{0};
+    chrono::steady_clock::time_point start;
+    mutex lock;
+    condition_variable wake;
+    bool finished = false;
+    thread reporter;
+    ~progress_meter();      // finish_progress, a sweep that throws must not leave the reporter joinable
+};
+
+extern bool progress_output;        // --progress / --no-progress, by default only when the log goes to a terminal
+#define PROGRESS_INTERVAL_MS 500
+
+struct blind_config {
+    double all_in, small_blind, big_blind;
+};
+
+struct nash_candidate {
+    packed_profile profile;
+    positions_values values;
+    double epsilon;
+};
+
+// a Nash sweep keeps at most this many candidates over all its threads, when it has to leave some out within the margin
+// the margin pass sweeps the space again instead
+#define NASH_CANDIDATES_MAX 1000000
+#define NASH_RESCAN_WINDOW 4                // chunks per thread the points of a margin pass sweeping again wait in
+extern uint64_t nash_candidates_max;        // --max-candidates
+
+struct result_sink {
+    string path;                        // csv of every nash point (--results), empty for none
+    size_t top = 0;                     // nash points kept in memory and printed (--top), 0 keeps none
+    ofstream file;
+    vector<nash_candidate> kept;        // a max heap on least_regret_first when top is set
+    uint64_t points = 0;
+};
+
+/* Sweep files: a sweep_file_header, the ranges of every axis of the space (int32 per range, axis after axis), the all in,
+ * small blind and big blind of every configuration (3 doubles each), one byte per chunk (1 once it was swept) and what the
+ * swept chunks left: the min tables of every configuration and position (MinMax) or the candidates as nash_candidate
+ * records (Nash). Written by --checkpoint and read back by --resume. */
+#define SWEEP_FILE_MAGIC "NEQSWEEP"
+#define SWEEP_FILE_VERSION 2
+#define SWEEP_FILE_MIN_CHUNKS 4096          // a saved sweep is split the same way whatever the threads of the run resuming it
+#define CHECKPOINT_INTERVAL_S 300
+#define SERVE_MAX_PROFILES 1000000000ull   // a serve request spanning more profiles is refused, --max-profiles
+
+enum sweep_kind {min_max_sweep_kind=1, nash_sweep_kind};
+
+struct sweep_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t kind;
+    uint32_t payoffs;           // 1 when the values come from a payoff_table, they differ from the staged ones in the last digits
+    uint32_t axis_sizes[STRATEGY_AXES_NUM];
+    uint32_t configs_num;
+    uint32_t reserved;
+    uint64_t tables_hash;
+    uint64_t chunks;
+    uint64_t candidates_num;    // Nash only
+    double delta;               // Nash only
+    double dropped_epsilon;     // Nash only, the least epsilon of the candidates left out, infinity when none was
+};
+
+struct sweep_state {
+    vector<char> swept;                                             // per chunk
+    vector<array<vector<double>, POSITIONS_NUM> > min_values;       // MinMax, per configuration and position
+    vector<nash_candidate> candidates;                              // Nash
+    double dropped_epsilon = numeric_limits<double>::infinity();   // Nash, least epsilon of the candidates left out
+};
+
+struct sweep_checkpoint {
+    string path;                        // empty when the sweep is not saved
+    bool resume = false;                // start from path when it exists
+    unsigned interval = CHECKPOINT_INTERVAL_S;
+    unsigned shard = 0, shards = 1;     // --shard, only the chunks from chunks * shard / shards to the next shard's first
+    vector<string> merge_files;         // merge, the sweeps of every shard are read instead of sweeping
+};
+
+struct sweep_saver {
+    string path;
+    unsigned interval;
+    sweep_file_header header;
+    strategy_space space;
+    vector<blind_config> configs;
+    vector<mutex> worker_locks;                 // a worker holds its own for the whole of a chunk
+    vector<vector<uint64_t> > worker_chunks;    // the chunks every worker swept, the resumed ones are worker 0's
+    mutex saving;
+    chrono::steady_clock::time_point saved;
+};
+
+struct run_options {
+    unsigned threads = 1;
+    int progress = -1;                  // 1 --progress, 0 --no-progress, -1 when the log is a terminal
+    bool prune = false;                 // drop dominated ranges before the Nash and BR solvers
+    double prune_epsilon = 0;
+    string equity_file = EQUITY_DATA_FILE;
+    string frequency_file = FREQUENCY_DATA_FILE;
+    string socket_path;
+    string blinds_file;                 // solve every blind_config of the file instead of the default blinds
+    string payoff_file;                 // payoff_table of the position's ranges, built when missing or stale
+    int range_step = 0;                 // every range between the preset ones in these steps, 0 keeps the presets
+    string results_file;
+    size_t top = 0;
+    string checkpoint_file;             // --checkpoint, the Nash sweep of every --blinds configuration gets a .N suffix
+    bool resume = false;
+    unsigned checkpoint_interval = CHECKPOINT_INTERVAL_S;
+    unsigned shard = 0, shards = 1;
+    uint64_t max_profiles = SERVE_MAX_PROFILES;
+    uint64_t max_candidates = NASH_CANDIDATES_MAX;
+};
+
+struct solve_request {
+    string id;          // raw json scalar echoed back in the response, empty when the request has none
+    string position;
+    string algorithm;
+    double all_in = 1.0, small_blind = 0.05, big_blind = 0.1;
+    unsigned threads;
+    strategy_space space;
+};
+
+/* Functions - done:
+ *      1. string_to_scenario - convert string to the Scenario enum value
+ *      2. convert the input to tuples in order to read the map_scenario_probability
+ *      3. find_scenario - Scenario named by a (not null terminated) string, false if there is none
+ *      4. get_ranges_equity -
+ *      5. read_ranges_equity_file -
+ *      6. read_scenario_probability_file -
+ *      7. calc_iteration_value - expected value of every position for one strategy_profile
+ *      8. find_maximal_strategy - dense index of the position's strategy of the largest value, the first one in range
+ *         order on ties
+ *      9. calc_min_max
+ *      10. calc_nash_definition
+ *      11. init_ranges
+ *      12. valid_params
+ *      13. print_help
+ *      14. build_scenario_probability_table - flatten map_scenario_probability into a scenario_probability_table
+ *      15. build_ranges_equity_table - expand map_ranges_equity to every seat order and validate it
+ *      16. build_range_buckets - index the range values present in a data file
+ *      17. make_strategy_space - bundle the candidate ranges of the solvers into a strategy_space
+ *      18. strategy_space_size - number of profiles spanned by a run of axes
+ *      19. cursor_seek / cursor_next - position a strategy_cursor / step it like the nested loops would
+ *      20. strategy_of - the position_strategy key of a strategy_profile
+ *      21. strategy_chunk_size - number of profiles in one unit of parallel work, the same for any threads when the sweep
+ *          is saved
+ *      22. run_chunks - run chunks of work on a pool of threads with work stealing
+ *      23. is_nash_point - check every unilateral deviation of a strategy_profile against a margin
+ *      24. parse_options - pull the --flags out of the command line
+ *      25. start_progress / report_progress / finish_progress - start the reporter of a progress_meter (when
+ *          progress_output is on) / add finished work to it / stop it with the final line
+ *      26. seat_strategy_index - dense index of a position's own strategy inside a strategy_cursor
+ *      27. seat_strategy - the position_strategy of a dense per position index
+ *      28. print_nash_points - print nash points and their values per position
+ *      29. strategy_position - index of a strategy_cursor profile inside its whole strategy_space
+ *      30. calc_best_response - nash point by iterated best responses of one position at a time
+ *      31. calc_nash_epsilon - largest relative gain of a unilateral deviation, i.e. the smallest margin a profile
+ *          meets (stops once it is above bound)
+ *      32. write_table_file / map_table_file - save a dense table as a binary table file / map one back
+ *      33. load_ranges_equity_table / load_scenario_probability_table - map a binary table file or parse a text one
+ *      34. table_file_path - the binary sibling of a text data file when it was converted, otherwise the file itself
+ *      35. convert_table_file / convert_data_file - the "convert" command / text data file to binary table file
+ *      36. map_file - map a whole file read only, nullptr if it can not be opened
+ *      37. scan_* - tokenize a text_scanner in place, false when the expected token is not next
+ *      38. parse_data_file - run a line parser over every line of a mapped text data file, reporting bad lines
+ *      39. serve - the "serve" command, answer line delimited json solve requests from stdin or a unix socket
+ *      40. serve_request - parse one json request line, run its solver and format the json response line
+ *      41. scan_json_string / scan_solve_request - read a json string / a solve request from a text_scanner
+ *      42. write_json_string / write_json_ranges - json output helpers of the responses
+ *      43. make_staged_evaluator - staged_evaluator for one blinds configuration, no profile staged yet
+ *      44. stage_profile - recompute the scenarios of a profile that depend on first_axis or an inner axis, only the
+ *          terms of positions first_seat to last_seat
+ *      45. staged_value - calc_iteration_value of the staged profile, summing the kept terms
+ *      46. make_deviation_engine - deviation_engine for one blinds configuration
+ *      47. best_deviation_value - best value a position gets by deviating alone, every strategy of the position summed
+ *          together in a staged_batch and reused while the other positions keep their strategies (or the first one that
+ *          exceeds, which stops the search)
+ *      48. first_difference - outermost axis two profiles differ in, STRATEGY_AXES_NUM if they are the same
+ *      49. prune_dominated_ranges - iterated elimination of the ranges of an axis that are dominated (by more than
+ *          epsilon) for their position against every remaining play of the other positions
+ *      50. stage_scenario / stage_scenarios - stage_profile of one scenario / of the scenarios at or inside an axis,
+ *          instantiated per scenario and staged positions so the payoff rows fold into the code
+ *      51. scenario_level / scenario_all_in - constexpr queries of the scenario_payoffs rows
+ *      52. record_phase / add_deviation_stats - add the time since start to a phase / the counters of a deviation
+ *          engine to stats, starting them over
+ *      53. write_stats - the --stats json: phases, counters and peak RSS
+ *      54. read_blind_configs - the --blinds file, one "all_in, small_blind, big_blind" per line
+ *      55. calc_min_max_batch - calc_min_max of several blind_configs in one sweep, the probabilities and equities of
+ *          every profile are looked up once and only the payoff terms are restaged per configuration
+ *      56. stage_terms / restage_blinds - payoff terms of one scenario from its probability and equity / the terms of
+ *          another evaluator's staged profile under this evaluator's blinds
+ *      57. check_total_probability / check_value_sum - the sanity checks of staged_value
+ *      58. build_payoff_table - payoff_coefficients of every profile of a strategy_space, one sweep of lookups
+ *      59. load_payoff_table - map a --payoff-cache file that covers the space and matches the tables, otherwise build
+ *          the table and write the file
+ *      60. write_payoff_file / map_payoff_file - save a payoff_table / map one back, nullptr when it can not be used
+ *      61. tables_fingerprint - hash of the equity and probability tables, ties a payoff file to its data
+ *      62. make_profile_packer / pack_profile / unpack_profile - profile_packer of a space / packed_profile of a strategy_profile
+ *          and back
+ *      63. payoff_value / payoff_seat_value - calc_iteration_value of a profile from its coefficients, no lookups
+ *      64. table_entry - flat index of four ranges in a table, -1 if one of them has no bucket
+ *      65. refine_range_grid - replace the tables by ones over exactly the ranges a strategy_space looks up, interpolating
+ *          the ranges between the buckets of the data (only when the space uses such a range)
+ *      66. grid_ranges - the ranges a strategy_space looks up on every key of the equity or the probability table
+ *      67. interpolate_table - fill a table over other buckets by multilinear interpolation between the data buckets
+ *      68. step_ranges - every range from the smallest to the largest of an axis in steps, --range-step
+ *      69. open_result_sink - start the --results csv with its header
+ *      70. add_nash_point - write a confirmed nash point to the csv and keep it when it is among the top least regret
+ *      71. least_regret_first - order of nash points by epsilon, then by profile
+ *      72. sink_nash_points - the nash points a result_sink kept, as map_strategy_values
+ *      73. make_sweep_header - sweep_file_header of a sweep
+ *      74. write_sweep_file / read_sweep_file - save a sweep_state / read one back, false when there is no file yet
+ *      75. start_sweep_saver - set up the sweep_saver of a sweep and resume or merge it, returns the chunks of the shard
+ *          left to sweep
+ *      76. save_checkpoint - write what every worker has swept so far, once per interval unless forced
+ *      77. add_sweep_state - merge the sweep_state of another shard into a sweep_state
+ *      78. checked_space_size - strategy_space_size of the whole space, false when it does not fit in 64 bits
+ *      79. make_staged_batch - staged_batch of a block of axes and positions, no profile staged yet
+ *      80. stage_batch - values of every profile of the block around a profile, restaging the scenarios that reach an
+ *          axis out of the block it changed
+ *      81. restage_batch_blinds - stage_batch of another batch's profile under this batch's blinds, from its probabilities
+ *          and equities
+ *      82. batch_value - staged_value of one profile of a staged_batch of every position
+ *      83. batch_first_axis - first axis of the innermost block of axes with at most max_profiles profiles
+ *      84. add_batch_terms / sum_batch - add the terms of one scenario to the values of every profile of a block / sum
+ *          every scenario of a staged_batch into its values
+ *      85. keep_batch_terms - keep what the evaluator of a staged_batch staged for one range of the scenario's axis
+ *      86. add_nash_candidate - keep a candidate in a max heap on least_regret_first of at most limit candidates, the
+ *          least epsilon it leaves out is recorded
+ *      78. valid_blinds - the all in and the blinds are finite and positive and no blind is larger than the all in
+ *      79. synthetic_ranges_equity / synthetic_scenario_probability - data tables in the format of the data files for
+ *          the benchmark and the tests, pushes with probability range / 100 and equities shared by the inverse of the ranges
+ *
+ */
+
+Scenario string_to_scenario(string& str);
+double get_scenario_probability(const scenario_probability_table & table, int co_range, int de_range, int sb_range, int bb_range, Scenario scenario);
+bool find_scenario(const char * name, size_t length, Scenario & scenario);
+
+const positions_equity & get_ranges_equity(const ranges_equity_table & table, int co_range, int de_range, int sb_range, int bb_range);
+map_ranges_equity read_ranges_equity_file(const string & path);
+ranges_equity_table build_ranges_equity_table(const map_ranges_equity & map);
+map_ranges_equity synthetic_ranges_equity(const positions_ranges & values);
+map_scenario_probability synthetic_scenario_probability(const positions_ranges & values);
+map_scenario_probability read_scenario_probability_file(const string & path);
+scenario_probability_table build_scenario_probability_table(const map_scenario_probability & map);
+range_buckets build_range_buckets(const vector<bool> & present);
+int64_t table_entry(const range_buckets * buckets, int co_range, int de_range, int sb_range, int bb_range);
+void refine_range_grid(ranges_equity_table & ranges_equity, scenario_probability_table & scenario_probability, const strategy_space & space);
+void grid_ranges(const strategy_space & space, bool equity, vector<bool> * present);
+void interpolate_table(const range_buckets * source, const double * source_data, const range_buckets * target, double * target_data,
+        uint32_t values_num, bool zero_node);
+void step_ranges(positions_ranges & ranges, int step);
+positions_values calc_iteration_value(double AllIn, double Bb, double Sb, const strategy_profile & profile,
+        const ranges_equity_table& ranges_equities, const scenario_probability_table& scenario_probabilities);
+staged_evaluator make_staged_evaluator(double AllIn, double Bb, double Sb,
+        const ranges_equity_table& ranges_equities, const scenario_probability_table& scenario_probabilities);
+void stage_profile(staged_evaluator & evaluator, const strategy_profile & profile, int first_axis, int first_seat, int last_seat);
+void restage_blinds(staged_evaluator & evaluator, const staged_evaluator & source, int first_axis);
+positions_values staged_value(const staged_evaluator & evaluator);
+void check_total_probability(double total_probability);
+void check_value_sum(const positions_values & iter_value, double Sb);
+staged_batch make_staged_batch(const staged_evaluator & evaluator, const strategy_space & space, int first_axis, int last_axis,
+        int first_seat, int last_seat);
+void stage_batch(staged_batch & batch, const strategy_profile & profile);
+void restage_batch_blinds(staged_batch & batch, const staged_batch & source);
+positions_values batch_value(const staged_batch & batch, uint64_t profile);
+void sum_batch(staged_batch & batch);
+void keep_batch_terms(staged_batch & batch, int scenario, uint64_t range);
+int batch_first_axis(const strategy_space & space, int first_axis, int last_axis, uint64_t max_profiles);
+deviation_engine make_deviation_engine(double AllIn, double Bb, double Sb,
+        const ranges_equity_table& ranges_equities, const scenario_probability_table& scenario_probabilities);
+int first_difference(const strategy_profile & profile, const strategy_profile & other);
+void add_deviation_stats(deviation_engine & engine);
+void record_phase(const string & phase, chrono::steady_clock::time_point start);
+void write_stats();
+uint64_t prune_dominated_ranges(const ranges_equity_table & ranges_equity, const scenario_probability_table & scenario_probability,
+        double AllIn, double SmallBlind, double BigBlind, double epsilon,
+        positions_ranges & co_range, positions_ranges & de_range, positions_ranges & de_co_range,
+        positions_ranges & sb_range, positions_ranges & sb_co_range, positions_ranges & sb_de_range, positions_ranges & sb_co_de_range,
+        positions_ranges & bb_co_range, positions_ranges & bb_de_range, positions_ranges & bb_sb_range,
+        positions_ranges & bb_co_de_range, positions_ranges & bb_co_sb_range, positions_ranges & bb_de_sb_range, positions_ranges & bb_co_de_sb_range);
+
+uint64_t find_maximal_strategy(const strategy_space & space, int seat, const vector<double> & values);
+vector<blind_config> read_blind_configs(const string & path);
+bool valid_blinds(const blind_config & blinds);
+
+payoff_table build_payoff_table(const ranges_equity_table & ranges_equity, const scenario_probability_table & scenario_probability,
+        const strategy_space & space, unsigned threads);
+payoff_table load_payoff_table(const string & path, const ranges_equity_table & ranges_equity,
+        const scenario_probability_table & scenario_probability, const strategy_space & space, unsigned threads);
+void write_payoff_file(const string & path, const payoff_table & table, uint64_t tables_hash);
+const payoff_coefficients * map_payoff_file(const string & path, uint64_t tables_hash, const strategy_space & space,
+        payoff_table & table);
+uint64_t tables_fingerprint(const ranges_equity_table & ranges_equity, const scenario_probability_table & scenario_probability);
+profile_packer make_profile_packer(const strategy_space & space);
+packed_profile pack_profile(const profile_packer & packer, const strategy_profile & profile);
+strategy_profile unpack_profile(const strategy_space & space, packed_profile profile);
+positions_values payoff_value(const payoff_coefficients & coefficients, const blind_config & blinds);
+double payoff_seat_value(const payoff_coefficients & coefficients, const double * blinds, int seat);
+
+vector<vector<position_strategy> > calc_min_max_batch(const ranges_equity_table & ranges_equity,
+        const scenario_probability_table & scenario_probability, const vector<blind_config> & configs,
+        unsigned threads, positions_ranges & co_range, positions_ranges & de_range, positions_ranges & de_co_range,
+        positions_ranges & sb_range, positions_ranges & sb_co_range, positions_ranges & sb_de_range, positions_ranges & sb_co_de_range,
+        positions_ranges & bb_co_range, positions_ranges & bb_de_range, positions_ranges & bb_sb_range,
+        positions_ranges & bb_co_de_range, positions_ranges & bb_co_sb_range, positions_ranges & bb_de_sb_range, positions_ranges & bb_co_de_sb_range,
+        const payoff_table * payoffs = nullptr, const sweep_checkpoint * checkpoint = nullptr);
+
+vector<position_strategy> calc_min_max(const ranges_equity_table & ranges_equity, const scenario_probability_table & scenario_probability, double AllIn, double SmallBlind, double BigBlind,
+        unsigned threads, positions_ranges & co_range, positions_ranges & de_range, positions_ranges & de_co_range,
+        positions_ranges & sb_range, positions_ranges & sb_co_range, positions_ranges & sb_de_range, positions_ranges & sb_co_de_range,
+        positions_ranges & bb_co_range, positions_ranges & bb_de_range, positions_ranges & bb_sb_range,
+        positions_ranges & bb_co_de_range, positions_ranges & bb_co_sb_range, positions_ranges & bb_de_sb_range, positions_ranges & bb_co_de_sb_range);
+
+strategy_space make_strategy_space(positions_ranges & co_range, positions_ranges & de_range, positions_ranges & de_co_range,
+        positions_ranges & sb_range, positions_ranges & sb_co_range, positions_ranges & sb_de_range, positions_ranges & sb_co_de_range,
+        positions_ranges & bb_co_range, positions_ranges & bb_de_range, positions_ranges & bb_sb_range,
+        positions_ranges & bb_co_de_range, positions_ranges & bb_co_sb_range, positions_ranges & bb_de_sb_range, positions_ranges & bb_co_de_sb_range);
+uint64_t strategy_space_size(const strategy_space & space, int first_axis, int last_axis);
+bool checked_space_size(const strategy_space & space, uint64_t & size);
+void cursor_seek(const strategy_space & space, strategy_cursor & cursor, uint64_t position, int first_axis, int last_axis);
+int cursor_next(const strategy_space & space, strategy_cursor & cursor, int first_axis, int last_axis);
+position_strategy strategy_of(const strategy_profile & profile);
+uint64_t strategy_chunk_size(const strategy_space & space, unsigned threads, bool saved = false);
+void run_chunks(uint64_t chunks, unsigned threads, const function<void(unsigned, uint64_t)> & work);
+void start_progress(progress_meter & meter, const string & name, const string & unit, uint64_t total);
+void report_progress(progress_meter & meter, uint64_t step);
+void finish_progress(progress_meter & meter);
+uint64_t seat_strategy_index(const strategy_space & space, const strategy_cursor & cursor, int seat);
+position_strategy seat_strategy(const strategy_space & space, int seat, uint64_t index);
+
+bool is_nash_point(deviation_engine & engine, double margin,
+        const strategy_space & space, const strategy_profile & profile, const positions_values & e);
+double calc_nash_epsilon(deviation_engine & engine, double bound,
+        const strategy_space & space, const strategy_profile & profile, const positions_values & e);
+
+map_strategy_values calc_nash_definition(const ranges_equity_table & ranges_equity, const scenario_probability_table & scenario_probability,
+        double AllIn, double SmallBlind, double BigBlind, double delta, unsigned threads,
+        positions_ranges & co_range, positions_ranges & de_range, positions_ranges & de_co_range,
+        positions_ranges & sb_range, positions_ranges & sb_co_range, positions_ranges & sb_de_range, positions_ranges & sb_co_de_range,
+        positions_ranges & bb_co_range, positions_ranges & bb_de_range, positions_ranges & bb_sb_range,
+        positions_ranges & bb_co_de_range, positions_ranges & bb_co_sb_range, positions_ranges & bb_de_sb_range, positions_ranges & bb_co_de_sb_range,
+        const payoff_table * payoffs = nullptr, result_sink * sink = nullptr, const sweep_checkpoint * checkpoint = nullptr);
+
+void print_nash_points(const map_strategy_values & nash_points_values);
+void open_result_sink(result_sink & sink, const string & path, size_t top);
+void add_nash_point(result_sink & sink, const strategy_space & space, const nash_candidate & point,
+        double AllIn, double SmallBlind, double BigBlind);
+bool least_regret_first(const nash_candidate & candidate, const nash_candidate & other);
+void add_nash_candidate(vector<nash_candidate> & candidates, size_t limit, const nash_candidate & candidate, double & dropped_epsilon);
+map_strategy_values sink_nash_points(const result_sink & sink, const strategy_space & space);
+
+sweep_file_header make_sweep_header(sweep_kind kind, const strategy_space & space, size_t configs_num, uint64_t tables_hash,
+        uint64_t chunks, bool payoffs, double delta);
+void write_sweep_file(const string & path, const sweep_file_header & header, const strategy_space & space,
+        const vector<blind_config> & configs, const sweep_state & state);
+bool read_sweep_file(const string & path, const sweep_file_header & expected, const strategy_space & space,
+        const vector<blind_config> & configs, sweep_state & state);
+vector<uint64_t> start_sweep_saver(sweep_saver & saver, const sweep_checkpoint * checkpoint, const sweep_file_header & header,
+        const strategy_space & space, const vector<blind_config> & configs, unsigned threads, sweep_state & resumed);
+void save_checkpoint(sweep_saver & saver, bool force, const function<void(unsigned, sweep_state &)> & add_worker);
+void add_sweep_state(sweep_state & state, const sweep_state & other, const string & path);
+
+void write_table_file(const string & path, table_kind kind, const range_buckets & buckets, uint32_t values_num, const double * data,
+        const struct stat & source);
+const double * map_table_file(const string & path, table_kind kind, range_buckets & buckets, uint32_t values_num,
+        shared_ptr<const void> & storage);
+bool is_table_file(const string & path);
+ranges_equity_table load_ranges_equity_table(const string & path);
+scenario_probability_table load_scenario_probability_table(const string & path);
+string table_file_path(const string & text_path);
+int convert_table_file(int argc, char *argv[]);
+void convert_data_file(table_kind kind, const string & text_path, const string & bin_path);
+shared_ptr<mapped_file> map_file(const string & path);
+void scan_spaces(text_scanner & scanner);
+bool scan_char(text_scanner & scanner, char expected);
+bool scan_int(text_scanner & scanner, int & value);
+bool scan_double(text_scanner & scanner, double & value);
+bool scan_scenario(text_scanner & scanner, Scenario & scenario);
+bool scan_line_end(text_scanner & scanner);
+uint64_t strategy_position(const strategy_space & space, const strategy_cursor & cursor);
+
+map_strategy_values calc_best_response(const ranges_equity_table & ranges_equity, const scenario_probability_table & scenario_probability,
+        double AllIn, double SmallBlind, double BigBlind, unsigned max_rounds,
+        positions_ranges & co_range, positions_ranges & de_range, positions_ranges & de_co_range,
+        positions_ranges & sb_range, positions_ranges & sb_co_range, positions_ranges & sb_de_range, positions_ranges & sb_co_de_range,
+        positions_ranges & bb_co_range, positions_ranges & bb_de_range, positions_ranges & bb_sb_range,
+        positions_ranges & bb_co_de_range, positions_ranges & bb_co_sb_range, positions_ranges & bb_de_sb_range, positions_ranges & bb_co_de_sb_range);
+
+int serve(const run_options & options, ostream & responses);
+string serve_request(const string & line, const ranges_equity_table & ranges_equity,
+        const scenario_probability_table & scenario_probability, const run_options & options);
+bool scan_json_string(text_scanner & scanner, string & value);
+bool scan_solve_request(text_scanner & scanner, solve_request & request, string & error);
+void write_json_string(ostream & out, const string & value);
+void write_json_ranges(ostream & out, positions_ranges::const_iterator first, positions_ranges::const_iterator last);
+
+void init_ranges(const string & pos, positions_ranges & co_range, positions_ranges & de_range, positions_ranges & de_co_range,
+                 positions_ranges & sb_range, positions_ranges & sb_co_range, positions_ranges & sb_de_range, positions_ranges & sb_co_de_range,
+                 positions_ranges & bb_co_range, positions_ranges & bb_de_range, positions_ranges & bb_sb_range,
+                 positions_ranges & bb_co_de_range, positions_ranges & bb_co_sb_range, positions_ranges & bb_de_sb_range, positions_ranges & bb_co_de_sb_range);
+
+bool valid_params(char *argv[], int argc);
+
+int parse_options(int argc, char *argv[], run_options & options);
+
+void print_help();
+
+#endif // NASH_EQ_CALC_H
@@ -0,0 +1,466 @@
+/* NashEqCalcTests - the binary files (table files, --payoff-cache files and --checkpoint files) read back what was
+ * written and refuse a damaged header, a Nash and a MinMax sweep split in two shards and merged give what the
+ * sweep gives in one run, both sweeps give what a brute force scan of the whole space gives and the batches of the
+ * sweeps give calc_iteration_value to the bit. Runs on tables generated in memory and writes its files to the working
+ * directory.
+ *
+ *      usage: NashEqCalcTests [filter]
+ *             only the tests whose name contains filter run, ctest runs every test on its own
+ *
+ * Every test prints one "-I- <name> passed" or "-E- <name> failed" line, the exit code is the number of failed tests.
+ */
+
+#include "nash_eq_calc.h"
+
+/* Functions - done:
+ *      1. run_test - run one test, print its line and count it when it fails
+ *      2. expect / expect_throw - fail the running test when a condition does not hold / when a call does not throw
+ *      3. test_tables - the synthetic equity and probability tables, built once
+ *      4. test_space - the strategy_space of the tests, two ranges on every axis
+ *      5. patch_file - overwrite bytes of a file in place, to damage its header
+ *      6. test_table_file / test_payoff_file / test_sweep_file - write a file, read it back, then damage it
+ *      7. test_shards_nash / test_shards_minmax - the sweep of 2 shards merged against the sweep in one run
+ *      8. uneven_space - a strategy_space of one to five ranges per axis, without a nash point at margin 0
+ *      9. brute_min_max - the min max strategies of a scan of calc_iteration_value over the whole space
+ *      10. brute_nash - the nash points of an is_nash_point scan over the whole space at growing margins
+ *      11. test_min_max / test_nash - calc_min_max and calc_nash_definition against their brute force scans
+ *      12. test_batch - the values of staged_batch blocks of the sweeps and of the deviations against
+ *          calc_iteration_value, bit for bit
+ *
+ */
+
+struct test_case {
+    const char * name;
+    void (*run)();
+};
+
+const double test_all_in = 1.0, test_small_blind = 0.05, test_big_blind = 0.1, test_delta = 0.02;
+
+int run_test(const test_case & test, const string & filter);
+void expect(bool condition, const string & what);
+void expect_throw(const function<void()> & call, const string & what);
+void test_tables(const ranges_equity_table * & ranges_equity, const scenario_probability_table * & scenario_probability);
+strategy_space test_space();
+void patch_file(const string & path, uint64_t offset, const void * data, size_t size);
+void test_table_file();
+void test_payoff_file();
+void test_sweep_file();
+void test_shards_nash();
+void test_shards_minmax();
+strategy_space uneven_space();
+vector<position_strategy> brute_min_max(const strategy_space & space);
+map_strategy_values brute_nash(const strategy_space & space, double delta);
+void test_min_max();
+void test_nash();
+void test_batch();
+
+int main(int argc, char *argv[]){
+    if(argc > 2){
+        cout << "--Help: NashEqCalcTests [filter]" << endl;
+        return 1;
+    }
+    const string filter = argc == 2 ? argv[1] : "";
+    const test_case tests[] = {{"table_file", test_table_file}, {"payoff_file", test_payoff_file}, {"sweep_file", test_sweep_file},
+                               {"shards_nash", test_shards_nash}, {"shards_minmax", test_shards_minmax},
+                               {"min_max_scan", test_min_max}, {"nash_scan", test_nash},
+                               {"batch", test_batch}};
+
+    int failed = 0;
+    for(const test_case & test : tests){
+        failed += run_test(test, filter);
+    }
+    return failed;
+}
+
+/* *****************************************************
+ * Implementations:
+ * *****************************************************
+ */
+
+int run_test(const test_case & test, const string & filter){
+    if(string(test.name).find(filter) == string::npos){
+        return 0;
+    }
+    cout << "-I- " << test.name << "..." << endl;
+    try{
+        test.run();
+    } catch(exception &){
+        cout << "-E- " << test.name << " failed" << endl;
+        return 1;
+    }
+    cout << "-I- " << test.name << " passed" << endl;
+    return 0;
+}
+
+void expect(bool condition, const string & what){
+    if(!condition){
+        cout << "-E- expected " << what << endl;
+        throw exception();
+    }
+}
+
+void expect_throw(const function<void()> & call, const string & what){
+    try{
+        call();
+    } catch(exception &){
+        return;
+    }
+    cout << "-E- expected " << what << " to be refused" << endl;
+    throw exception();
+}
+
+void test_tables(const ranges_equity_table * & ranges_equity, const scenario_probability_table * & scenario_probability){
+    static const positions_ranges values{0, 10, 20, 30, 50, 70};
+    static const ranges_equity_table equity = build_ranges_equity_table(synthetic_ranges_equity(values));
+    static const scenario_probability_table probability = build_scenario_probability_table(synthetic_scenario_probability(values));
+    ranges_equity = &equity;
+    scenario_probability = &probability;
+}
+
+strategy_space test_space(){
+    // 2^14 profiles, enough for many chunks per shard and still a quick Nash sweep
+    strategy_space space;
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        space.axes[axis] = positions_ranges{10, 30};
+    }
+    return space;
+}
+
+void patch_file(const string & path, uint64_t offset, const void * data, size_t size){
+    fstream myfile(path, ios::binary | ios::in | ios::out);
+    myfile.seekp(offset);
+    myfile.write(static_cast<const char *>(data), size);
+    expect(bool(myfile), "to patch " + path);
+}
+
+void test_table_file(){
+    const ranges_equity_table * ranges_equity;
+    const scenario_probability_table * scenario_probability;
+    test_tables(ranges_equity, scenario_probability);
+    struct stat source;
+    expect(stat(".", &source) == 0, "a source to stat");
+    const uint64_t n = ranges_equity->buckets[0].values.size(), entries = n * n * n * n;
+
+    const string equity_path = "test_equity.bin", probability_path = "test_probability.bin";
+    write_table_file(equity_path, equity_table_kind, ranges_equity->buckets[0], POSITIONS_NUM, ranges_equity->equities[0].data(), source);
+    write_table_file(probability_path, probability_table_kind, scenario_probability->buckets[0], SCENARIOS_NUM,
+                     scenario_probability->probabilities, source);
+    const ranges_equity_table equity = load_ranges_equity_table(equity_path);
+    const scenario_probability_table probability = load_scenario_probability_table(probability_path);
+    for(int key = 0; key < POSITIONS_NUM; key++){
+        expect(equity.buckets[key].values == ranges_equity->buckets[key].values, "the equity buckets read back");
+        expect(probability.buckets[key].values == scenario_probability->buckets[key].values, "the probability buckets read back");
+    }
+    // bitwise, the entries missing from the data are NaN
+    expect(memcmp(equity.equities, ranges_equity->equities, entries * sizeof(positions_equity)) == 0, "the equities read back");
+    expect(memcmp(probability.probabilities, scenario_probability->probabilities, entries * SCENARIOS_NUM * sizeof(double)) == 0,
+           "the probabilities read back");
+
+    expect_throw([&]{ load_scenario_probability_table(equity_path); }, "an equity table file as probabilities");
+    const uint32_t buckets_num = 0xffffffffu, version = TABLE_FILE_VERSION + 1;
+    patch_file(equity_path, offsetof(table_file_header, buckets_num), &buckets_num, sizeof(buckets_num));
+    expect_throw([&]{ load_ranges_equity_table(equity_path); }, "a table file of 2^32 buckets");
+    patch_file(probability_path, offsetof(table_file_header, version), &version, sizeof(version));
+    expect_throw([&]{ load_scenario_probability_table(probability_path); }, "a table file of another version");
+    write_table_file(equity_path, equity_table_kind, ranges_equity->buckets[0], POSITIONS_NUM, ranges_equity->equities[0].data(), source);
+    for(uint64_t data_offset : {uint64_t(1) << 40, numeric_limits<uint64_t>::max() - 7}){
+        patch_file(equity_path, offsetof(table_file_header, data_offset), &data_offset, sizeof(data_offset));
+        expect_throw([&]{ load_ranges_equity_table(equity_path); }, "a table file with its data out of the file");
+    }
+    remove(equity_path.c_str());
+    remove(probability_path.c_str());
+}
+
+void test_payoff_file(){
+    const ranges_equity_table * ranges_equity;
+    const scenario_probability_table * scenario_probability;
+    test_tables(ranges_equity, scenario_probability);
+    const strategy_space space = test_space();
+    const uint64_t tables_hash = tables_fingerprint(*ranges_equity, *scenario_probability),
+            profiles = strategy_space_size(space, 0, STRATEGY_AXES_NUM);
+
+    const string path = "test_payoff.bin";
+    const payoff_table built = build_payoff_table(*ranges_equity, *scenario_probability, space, 1);
+    write_payoff_file(path, built, tables_hash);
+    payoff_table mapped;
+    const payoff_coefficients * coefficients = map_payoff_file(path, tables_hash, space, mapped);
+    expect(coefficients != nullptr, "the payoff file to map");
+    expect(memcmp(coefficients, built.coefficients, profiles * sizeof(payoff_coefficients)) == 0, "the coefficients read back");
+
+    // a narrower space is served by the same file
+    strategy_space narrow = space;
+    narrow.axes[0] = positions_ranges{30};
+    payoff_table narrow_mapped;
+    expect(map_payoff_file(path, tables_hash, narrow, narrow_mapped) != nullptr, "the payoff file to serve a narrower space");
+
+    payoff_table refused;
+    expect(map_payoff_file(path, tables_hash + 1, space, refused) == nullptr, "a payoff file of other tables to be refused");
+    const uint32_t axis_size = 0xffffffffu;
+    patch_file(path, offsetof(payoff_file_header, axis_sizes), &axis_size, sizeof(axis_size));
+    expect(map_payoff_file(path, tables_hash, space, refused) == nullptr, "a payoff file of 2^32 ranges to be refused");
+    write_payoff_file(path, built, tables_hash);
+    for(uint64_t data_offset : {uint64_t(8), numeric_limits<uint64_t>::max() - 7}){
+        patch_file(path, offsetof(payoff_file_header, data_offset), &data_offset, sizeof(data_offset));
+        expect(map_payoff_file(path, tables_hash, space, refused) == nullptr, "a payoff file with its data out of the file to be refused");
+    }
+    remove(path.c_str());
+}
+
+void test_sweep_file(){
+    const strategy_space space = test_space();
+    const vector<blind_config> configs{blind_config{test_all_in, test_small_blind, test_big_blind},
+                                       blind_config{2 * test_all_in, test_small_blind, test_big_blind}};
+    const string path = "test_sweep.bin";
+    sweep_state missing;
+    expect(!read_sweep_file(path, make_sweep_header(nash_sweep_kind, space, 1, 1, 8, false, test_delta), space,
+                            vector<blind_config>{configs[0]}, missing), "no sweep file yet");
+
+    // Nash: the candidates
+    const sweep_file_header nash_header = make_sweep_header(nash_sweep_kind, space, 1, 1, 8, false, test_delta);
+    sweep_state nash;
+    nash.swept = {1, 0, 1, 1, 0, 0, 1, 0};
+    nash.candidates = {nash_candidate{5, {0.25, -0.5, 0.125, 0.125}, 0.01}, nash_candidate{70, {-1, 0.5, 0.25, 0.25}, 0.03}};
+    nash.dropped_epsilon = 0.04;
+    write_sweep_file(path, nash_header, space, vector<blind_config>{configs[0]}, nash);
+    sweep_state nash_read;
+    expect(read_sweep_file(path, nash_header, space, vector<blind_config>{configs[0]}, nash_read), "the Nash sweep file to read");
+    expect(nash_read.swept == nash.swept, "the swept chunks read back");
+    expect(nash_read.candidates.size() == nash.candidates.size() &&
+           memcmp(nash_read.candidates.data(), nash.candidates.data(), nash.candidates.size() * sizeof(nash_candidate)) == 0,
+           "the candidates read back");
+    expect(nash_read.dropped_epsilon == nash.dropped_epsilon, "the least epsilon left out read back");
+    sweep_state refused;
+    expect_throw([&]{ read_sweep_file(path, make_sweep_header(nash_sweep_kind, space, 1, 1, 8, false, 2 * test_delta), space,
+                                      vector<blind_config>{configs[0]}, refused); }, "a sweep file of another delta");
+    const uint64_t candidates_num = uint64_t(1) << 60;
+    patch_file(path, offsetof(sweep_file_header, candidates_num), &candidates_num, sizeof(candidates_num));
+    expect_throw([&]{ read_sweep_file(path, nash_header, space, vector<blind_config>{configs[0]}, refused); },
+                 "a sweep file of 2^60 candidates");
+
+    // MinMax: the min tables of every configuration and position
+    const sweep_file_header min_max_header = make_sweep_header(min_max_sweep_kind, space, configs.size(), 1, 4, false, 0);
+    sweep_state min_max;
+    min_max.swept = {0, 1, 1, 0};
+    min_max.min_values.resize(configs.size());
+    for(size_t config = 0; config < configs.size(); config++){
+        for(int seat = 0; seat < POSITIONS_NUM; seat++){
+            min_max.min_values[config][seat].resize(strategy_space_size(space, seat_axes[seat], seat_axes[seat + 1]));
+            for(size_t i = 0; i < min_max.min_values[config][seat].size(); i++){
+                min_max.min_values[config][seat][i] = config + seat * 0.5 - i * 0.125;
+            }
+        }
+    }
+    write_sweep_file(path, min_max_header, space, configs, min_max);
+    sweep_state min_max_read;
+    expect(read_sweep_file(path, min_max_header, space, configs, min_max_read), "the MinMax sweep file to read");
+    expect(min_max_read.swept == min_max.swept && min_max_read.min_values == min_max.min_values, "the min tables read back");
+    expect_throw([&]{ read_sweep_file(path, min_max_header, space, vector<blind_config>{configs[1], configs[0]}, refused); },
+                 "a sweep file of other blinds");
+    remove(path.c_str());
+}
+
+void test_shards_nash(){
+    const ranges_equity_table * ranges_equity;
+    const scenario_probability_table * scenario_probability;
+    test_tables(ranges_equity, scenario_probability);
+    auto solve = [&](const sweep_checkpoint * checkpoint){
+        strategy_space axes = test_space();
+        return calc_nash_definition(*ranges_equity, *scenario_probability, test_all_in, test_small_blind, test_big_blind, test_delta, 2,
+                                    axes.axes[0], axes.axes[1], axes.axes[2], axes.axes[3], axes.axes[4], axes.axes[5], axes.axes[6],
+                                    axes.axes[7], axes.axes[8], axes.axes[9], axes.axes[10], axes.axes[11], axes.axes[12], axes.axes[13],
+                                    nullptr, nullptr, checkpoint);
+    };
+
+    const map_strategy_values whole = solve(nullptr);
+    sweep_checkpoint merge;
+    for(unsigned shard = 0; shard < 2; shard++){
+        sweep_checkpoint checkpoint;
+        checkpoint.path = "test_shard_nash." + to_string(shard);
+        checkpoint.shard = shard;
+        checkpoint.shards = 2;
+        expect(solve(&checkpoint).empty(), "no nash points from a shard");
+        merge.merge_files.push_back(checkpoint.path);
+    }
+    const map_strategy_values merged = solve(&merge);
+    expect(!whole.empty(), "nash points");
+    expect(merged == whole, "the merged shards to give the nash points of the whole sweep");
+    for(const string & path : merge.merge_files){
+        remove(path.c_str());
+    }
+}
+
+void test_shards_minmax(){
+    const ranges_equity_table * ranges_equity;
+    const scenario_probability_table * scenario_probability;
+    test_tables(ranges_equity, scenario_probability);
+    const vector<blind_config> configs{blind_config{test_all_in, test_small_blind, test_big_blind},
+                                       blind_config{test_all_in, 2 * test_small_blind, 2 * test_big_blind}};
+    auto solve = [&](const sweep_checkpoint * checkpoint){
+        strategy_space axes = test_space();
+        return calc_min_max_batch(*ranges_equity, *scenario_probability, configs, 2,
+                                  axes.axes[0], axes.axes[1], axes.axes[2], axes.axes[3], axes.axes[4], axes.axes[5], axes.axes[6],
+                                  axes.axes[7], axes.axes[8], axes.axes[9], axes.axes[10], axes.axes[11], axes.axes[12], axes.axes[13],
+                                  nullptr, checkpoint);
+    };
+
+    const vector<vector<position_strategy> > whole = solve(nullptr);
+    sweep_checkpoint merge;
+    for(unsigned shard = 0; shard < 2; shard++){
+        sweep_checkpoint checkpoint;
+        checkpoint.path = "test_shard_minmax." + to_string(shard);
+        checkpoint.shard = shard;
+        checkpoint.shards = 2;
+        solve(&checkpoint);
+        merge.merge_files.push_back(checkpoint.path);
+    }
+    const vector<vector<position_strategy> > merged = solve(&merge);
+    expect(whole.size() == configs.size(), "a min max result per configuration");
+    expect(merged == whole, "the merged shards to give the min max strategies of the whole sweep");
+    for(const string & path : merge.merge_files){
+        remove(path.c_str());
+    }
+}
+
+strategy_space uneven_space(){
+    // 34560 profiles, the least margin of a profile is about 0.37 so the margin loop grows many deltas before its first point
+    strategy_space space;
+    const positions_ranges axes[STRATEGY_AXES_NUM] = {{50, 70}, {10, 50}, {30, 70}, {10, 50}, {10, 20, 30, 70}, {30}, {30, 70},
+                                                      {50, 70}, {30}, {10, 30, 70}, {10, 20, 30, 50, 70}, {20, 50, 70}, {50},
+                                                      {20, 50, 70}};
+    for(int axis = 0; axis < STRATEGY_AXES_NUM; axis++){
+        space.axes[axis] = axes[axis];
+    }
+    return space;
+}
+
+vector<position_strategy> brute_min_max(const strategy_space & space){
+    const ranges_equity_table * ranges_equity;
+    const scenario_probability_table * scenario_probability;
+    test_tables(ranges_equity, scenario_probability);
+    vector<double> min_values[POSITIONS_NUM];
+    for(int seat = 0; seat < POSITIONS_NUM; seat++){
+        min_values[seat].assign(strategy_space_size(space, seat_axes[seat], seat_axes[seat + 1]), 100);
+    }
+    strategy_cursor cursor;
+    cursor_seek(space, cursor, 0, 0, STRATEGY_AXES_NUM);
+    for(uint64_t i = 0; i < strategy_space_size(space, 0, STRATEGY_AXES_NUM); i++, cursor_next(space, cursor, 0, STRATEGY_AXES_NUM)){
+        const positions_values e = calc_iteration_value(test_all_in, test_big_blind, test_small_blind, cursor.profile,
+                                                        *ranges_equity, *scenario_probability);
+        for(int seat = 0; seat < POSITIONS_NUM; seat++){
+            double & min_value = min_values[seat][seat_strategy_index(space, cursor, seat)];
+            min_value = min(min_value, e[seat]);
+        }
+    }
+    vector<position_strategy> result;
+    for(int seat = 0; seat < POSITIONS_NUM; seat++){
+        result.push_back(seat_strategy(space, seat, find_maximal_strategy(space, seat, min_values[seat])));
+    }
+    return result;
+}
+
+map_strategy_values brute_nash(const strategy_space & space, double delta){
+    const ranges_equity_table * ranges_equity;
+    const scenario_probability_table * scenario_probability;
+    test_tables(ranges_equity, scenario_probability);
+    deviation_engine engine = make_deviation_engine(test_all_in, test_big_blind, test_small_blind, *ranges_equity, *scenario_probability);
+    map_strategy_values points;
+    for(double margin = delta; points.empty(); margin += delta){
+        strategy_cursor cursor;
+        cursor_seek(space, cursor, 0, 0, STRATEGY_AXES_NUM);
+        for(uint64_t i = 0; i < strategy_space_size(space, 0, STRATEGY_AXES_NUM); i++, cursor_next(space, cursor, 0, STRATEGY_AXES_NUM)){
+            const positions_values e = calc_iteration_value(test_all_in, test_big_blind, test_small_blind, cursor.profile,
+                                                            *ranges_equity, *scenario_probability);
+            if(is_nash_point(engine, margin, space, cursor.profile, e)){
+                points[strategy_of(cursor.profile)] = positions_expectancy(e.begin(), e.end());
+            }
+        }
+    }
+    return points;
+}
+
+void test_min_max(){
+    const ranges_equity_table * ranges_equity;
+    const scenario_probability_table * scenario_probability;
+    test_tables(ranges_equity, scenario_probability);
+    for(const strategy_space & space : {test_space(), uneven_space()}){
+        const vector<position_strategy> brute = brute_min_max(space);
+        for(unsigned threads : {1u, 3u}){
+            strategy_space axes = space;
+            const vector<position_strategy> swept = calc_min_max(*ranges_equity, *scenario_probability, test_all_in, test_small_blind,
+                    test_big_blind, threads, axes.axes[0], axes.axes[1], axes.axes[2], axes.axes[3], axes.axes[4], axes.axes[5],
+                    axes.axes[6], axes.axes[7], axes.axes[8], axes.axes[9], axes.axes[10], axes.axes[11], axes.axes[12], axes.axes[13]);
+            expect(swept == brute, "the min max strategies of " + to_string(threads) + " threads to be those of the brute force scan");
+        }
+    }
+}
+
+void test_nash(){
+    const ranges_equity_table * ranges_equity;
+    const scenario_probability_table * scenario_probability;
+    test_tables(ranges_equity, scenario_probability);
+    for(const strategy_space & space : {test_space(), uneven_space()}){
+        const map_strategy_values brute = brute_nash(space, test_delta);
+        // one candidate leaves out the others, so the margin pass sweeps the space again
+        for(uint64_t candidates_max : {uint64_t(NASH_CANDIDATES_MAX), uint64_t(1)}){
+            nash_candidates_max = candidates_max;
+            for(unsigned threads : {1u, 3u}){
+                strategy_space axes = space;
+                const map_strategy_values swept = calc_nash_definition(*ranges_equity, *scenario_probability, test_all_in, test_small_blind,
+                        test_big_blind, test_delta, threads, axes.axes[0], axes.axes[1], axes.axes[2], axes.axes[3], axes.axes[4], axes.axes[5],
+                        axes.axes[6], axes.axes[7], axes.axes[8], axes.axes[9], axes.axes[10], axes.axes[11], axes.axes[12], axes.axes[13]);
+                expect(swept == brute, "the nash points of " + to_string(threads) + " threads and " + to_string(candidates_max) +
+                                       " candidates to be those of the brute force scan");
+            }
+        }
+        nash_candidates_max = NASH_CANDIDATES_MAX;
+    }
+}
+
+void test_batch(){
+    const ranges_equity_table * ranges_equity;
+    const scenario_probability_table * scenario_probability;
+    test_tables(ranges_equity, scenario_probability);
+    const strategy_space space = uneven_space();
+    const uint64_t profiles = strategy_space_size(space, 0, STRATEGY_AXES_NUM);
+    // blocks of several axes, of one axis, of an axis that is not innermost and an empty one
+    for(int first_axis : {seat_axes[3], 10, 11, STRATEGY_AXES_NUM}){
+        staged_batch batch = make_staged_batch(make_staged_evaluator(test_all_in, test_big_blind, test_small_blind, *ranges_equity,
+                                                                     *scenario_probability),
+                                               space, first_axis, STRATEGY_AXES_NUM, 0, POSITIONS_NUM);
+        strategy_cursor cursor;
+        cursor_seek(space, cursor, 0, 0, STRATEGY_AXES_NUM);
+        for(uint64_t i = 0; i < profiles; i++, cursor_next(space, cursor, 0, STRATEGY_AXES_NUM)){
+            if(i % batch.size == 0){
+                stage_batch(batch, cursor.profile);
+            }
+            const positions_values value = batch_value(batch, i % batch.size),
+                    expected = calc_iteration_value(test_all_in, test_big_blind, test_small_blind, cursor.profile, *ranges_equity,
+                                                    *scenario_probability);
+            expect(memcmp(&value, &expected, sizeof(value)) == 0,
+                   "the batch from axis " + to_string(first_axis) + " to give calc_iteration_value of profile " + to_string(i));
+        }
+    }
+
+    // the deviations of one position, over all of its axes and over its innermost one
+    for(int seat = 0; seat < POSITIONS_NUM; seat++){
+        for(int first_axis : {seat_axes[seat], seat_axes[seat + 1] - 1}){
+            staged_batch batch = make_staged_batch(make_staged_evaluator(test_all_in, test_big_blind, test_small_blind, *ranges_equity,
+                                                                         *scenario_probability),
+                                                   space, first_axis, seat_axes[seat + 1], seat, seat + 1);
+            strategy_cursor cursor;
+            cursor_seek(space, cursor, 0, 0, STRATEGY_AXES_NUM);
+            for(uint64_t i = 0; i < profiles; i += 97, cursor_seek(space, cursor, i, 0, STRATEGY_AXES_NUM)){
+                stage_batch(batch, cursor.profile);
+                strategy_cursor deviation = cursor;
+                cursor_seek(space, deviation, 0, first_axis, seat_axes[seat + 1]);
+                for(uint64_t j = 0; j < batch.size; j++, cursor_next(space, deviation, first_axis, seat_axes[seat + 1])){
+                    const double expected = calc_iteration_value(test_all_in, test_big_blind, test_small_blind, deviation.profile,
+                                                                 *ranges_equity, *scenario_probability)[seat];
+                    expect(memcmp(&batch.values[seat][j], &expected, sizeof(expected)) == 0,
+                           "the deviation batch of position " + to_string(seat) + " from axis " + to_string(first_axis) +
+                           " to give calc_iteration_value");
+                }
+            }
+        }
+    }
+}